@@ -0,0 +1,136 @@
+// bench/conv_downsample.c
+// ResNet-50 shortcut (1x1, stride 2, padding 0) conv 비교 :
+//   (a) 일반 conv tiling 인 tiled_conv_stride_auto
+//   (b) run_conv 가 이 모양에서 쓰는 tiled_conv_downsample (출력 행마다 stride-2 matmul 하나)
+// 로 각 stage 의 shortcut layer 를 실행해 cycle 수와 결과 일치 여부를 출력
+//
+// backend 빌드에는 포함되지 않는 단독 프로그램 (Gemmini 가 붙은 SoC 또는 시뮬레이터에서 실행)
+//   riscv64-unknown-linux-gnu-gcc -O2 -static -march=rv64gc -I$GEM_HOME/gemmini-rocc-tests -I.. conv_downsample.c -o conv_downsample
+//   (baremetal 이면 gemmini-rocc-tests 의 bareMetalC 와 같은 link 옵션 사용)
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#ifndef BAREMETAL
+#include <sys/mman.h>
+#endif
+
+#include "gemmini.h"
+
+#ifndef BENCH_BATCH
+#define BENCH_BATCH 1
+#endif
+
+#ifndef BENCH_REPEAT
+#define BENCH_REPEAT 4
+#endif
+
+static uint64_t read_cycles(void)
+{
+    uint64_t cycles;
+    asm volatile("rdcycle %0" : "=r"(cycles));
+    return cycles;
+}
+
+// ResNet-50 conv3_1 / conv4_1 / conv5_1 의 projection shortcut (입력 HxW, IC -> OC)
+struct shortcut_layer
+{
+    const char *name;
+    int in_dim, in_channels, out_channels;
+};
+
+static const struct shortcut_layer layers[] = {
+    {"conv3_1", 56, 256, 512},
+    {"conv4_1", 28, 512, 1024},
+    {"conv5_1", 14, 1024, 2048},
+};
+
+static elem_t *alloc_i8(size_t n)
+{
+    elem_t *p = (elem_t *)aligned_alloc(16, (n + 15) / 16 * 16);
+    if (!p) {
+        printf("alloc failed: %zu bytes\n", n);
+        exit(1);
+    }
+    return p;
+}
+
+int main(void)
+{
+#ifndef BAREMETAL
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        perror("mlockall failed");
+        exit(1);
+    }
+#endif
+    gemmini_flush(0);
+
+    printf("%-8s %-18s | %12s | %12s | %7s %s\n", "layer", "shape", "conv cyc", "downsample", "speedup", "match");
+
+    for (size_t l = 0; l < sizeof(layers) / sizeof(layers[0]); l++) {
+        const struct shortcut_layer *L = &layers[l];
+        const int N = BENCH_BATCH, D = L->in_dim, OD = (D + 1) / 2;
+        const int IC = L->in_channels, OC = L->out_channels;
+
+        // NHWC 입력, [IC] x OC weight (HWIO 의 1x1)
+        elem_t *in = alloc_i8((size_t)N * D * D * IC);
+        elem_t *w = alloc_i8((size_t)IC * OC);
+        elem_t *out0 = alloc_i8((size_t)N * OD * OD * OC);
+        elem_t *out1 = alloc_i8((size_t)N * OD * OD * OC);
+
+        for (size_t i = 0; i < (size_t)N * D * D * IC; i++)
+            in[i] = (elem_t)((int)(rand() % 8) - 4);
+        for (size_t i = 0; i < (size_t)IC * OC; i++)
+            w[i] = (elem_t)((int)(rand() % 8) - 4);
+
+        uint64_t conv = UINT64_MAX, down = UINT64_MAX;
+        for (int r = 0; r < BENCH_REPEAT; r++) {
+            uint64_t t0 = read_cycles();
+            tiled_conv_stride_auto(
+                N, D, D, IC,
+                OC, OD, OD,
+                2, 1, 1, 0, 1,
+                IC, OC, OC,
+                false, false, false, false, false,
+                in, w, NULL, out0,
+                NO_ACTIVATION, ACC_SCALE_IDENTITY,
+                1, 0, 0,
+                WS);
+            uint64_t t1 = read_cycles();
+            if (t1 - t0 < conv)
+                conv = t1 - t0;
+
+            t0 = read_cycles();
+            tiled_conv_downsample(
+                N, D, D, IC,
+                OC, OD, OD,
+                IC, OC, OC,
+                in, w, NULL, out1,
+                NO_ACTIVATION, ACC_SCALE_IDENTITY,
+                WS);
+            t1 = read_cycles();
+            if (t1 - t0 < down)
+                down = t1 - t0;
+        }
+
+        int match = 1;
+        for (size_t i = 0; i < (size_t)N * OD * OD * OC; i++)
+            if (out0[i] != out1[i]) {
+                match = 0;
+                break;
+            }
+
+        char shape[32];
+        snprintf(shape, sizeof(shape), "%dx%dx%d->%d", D, D, IC, OC);
+        printf("%-8s %-18s | %12llu | %12llu | %6.2fx %s\n",
+               L->name, shape, (unsigned long long)conv, (unsigned long long)down,
+               (double)conv / (double)down, match ? "ok" : "MISMATCH");
+
+        free(in);
+        free(w);
+        free(out0);
+        free(out1);
+    }
+
+    return 0;
+}
@@ -0,0 +1,130 @@
+// bench/resadd_residual.c
+// tiled_resadd_stride_auto 의 tile 선택 비교 : residual stream 크기 (seq x 4096) 의 int8 ADD 를
+//   (a) 이전 탐색 loop 가 고르던 tile 로 tiled_resadd 직접 호출
+//   (b) closed-form tile 을 고르는 tiled_resadd_stride_auto
+// 로 각각 실행해 cycle 수와 결과 일치 여부를 출력
+//
+// backend 빌드에는 포함되지 않는 단독 프로그램 (Gemmini 가 붙은 SoC 또는 시뮬레이터에서 실행)
+//   riscv64-unknown-linux-gnu-gcc -O2 -static -march=rv64gc -I$GEM_HOME/gemmini-rocc-tests -I.. resadd_residual.c -o resadd_residual
+//   (baremetal 이면 gemmini-rocc-tests 의 bareMetalC 와 같은 link 옵션 사용)
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#ifndef BAREMETAL
+#include <sys/mman.h>
+#endif
+
+#include "gemmini.h"
+
+#ifndef BENCH_J
+#define BENCH_J 4096
+#endif
+
+#ifndef BENCH_REPEAT
+#define BENCH_REPEAT 4
+#endif
+
+static uint64_t read_cycles(void)
+{
+    uint64_t cycles;
+    asm volatile("rdcycle %0" : "=r"(cycles));
+    return cycles;
+}
+
+// 이전 tiled_resadd_stride_auto 의 tile 탐색 (closed-form 도입 전)
+static void legacy_tiles(size_t I, size_t J, size_t *tile_I_out, size_t *tile_J_out)
+{
+    size_t tile_I = I, tile_J = J;
+    size_t total_acc_rows = (tile_I / DIM + (tile_I % DIM != 0)) * DIM * (tile_J / DIM + (tile_J % DIM != 0));
+
+    while (total_acc_rows > ACC_ROWS / 2) {
+        if (tile_I >= tile_J || tile_J <= DIM)
+            tile_I /= 2;
+        else
+            tile_J -= DIM;
+
+        total_acc_rows = (tile_I / DIM + (tile_I % DIM != 0)) * DIM * (tile_J / DIM + (tile_J % DIM != 0));
+    }
+
+    *tile_I_out = tile_I;
+    *tile_J_out = tile_J;
+}
+
+static elem_t *alloc_i8(size_t n)
+{
+    elem_t *p = (elem_t *)aligned_alloc(16, (n + 15) / 16 * 16);
+    if (!p) {
+        printf("alloc failed: %zu bytes\n", n);
+        exit(1);
+    }
+    return p;
+}
+
+int main(void)
+{
+    static const size_t seqs[] = {1, 16, 64, 128, 512};
+    const size_t J = BENCH_J, stride = BENCH_J;
+
+#ifndef BAREMETAL
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        perror("mlockall failed");
+        exit(1);
+    }
+#endif
+    gemmini_flush(0);
+
+    printf("%6s %6s | %-13s %12s | %12s | %7s %s\n", "I", "J", "legacy tile", "legacy cyc", "closed cyc", "speedup", "match");
+
+    for (size_t s = 0; s < sizeof(seqs) / sizeof(seqs[0]); s++) {
+        const size_t I = seqs[s];
+        elem_t *A = alloc_i8(I * stride), *B = alloc_i8(I * stride);
+        elem_t *C0 = alloc_i8(I * stride), *C1 = alloc_i8(I * stride);
+
+        for (size_t i = 0; i < I * stride; i++) {
+            A[i] = (elem_t)((int)(rand() % 128) - 64);
+            B[i] = (elem_t)((int)(rand() % 128) - 64);
+        }
+
+        size_t tile_I, tile_J;
+        legacy_tiles(I, J, &tile_I, &tile_J);
+
+        uint64_t legacy = UINT64_MAX, closed = UINT64_MAX;
+        for (int r = 0; r < BENCH_REPEAT; r++) {
+            uint64_t t0 = read_cycles();
+            tiled_resadd(I, J, stride, tile_I, tile_J,
+                         MVIN_SCALE_IDENTITY, MVIN_SCALE_IDENTITY, ACC_SCALE_IDENTITY,
+                         A, B, C0, false, WS);
+            uint64_t t1 = read_cycles();
+            if (t1 - t0 < legacy)
+                legacy = t1 - t0;
+
+            t0 = read_cycles();
+            tiled_resadd_stride_auto(I, J,
+                                     MVIN_SCALE_IDENTITY, MVIN_SCALE_IDENTITY, ACC_SCALE_IDENTITY,
+                                     stride, A, B, C1, false, WS);
+            t1 = read_cycles();
+            if (t1 - t0 < closed)
+                closed = t1 - t0;
+        }
+
+        int match = 1;
+        for (size_t i = 0; i < I && match; i++)
+            for (size_t j = 0; j < J; j++)
+                if (C0[i * stride + j] != C1[i * stride + j]) {
+                    match = 0;
+                    break;
+                }
+
+        printf("%6zu %6zu | %5zu x %-5zu %12llu | %12llu | %6.2fx %s\n",
+               I, J, tile_I, tile_J, (unsigned long long)legacy, (unsigned long long)closed,
+               (double)legacy / (double)closed, match ? "ok" : "MISMATCH");
+
+        free(A);
+        free(B);
+        free(C0);
+        free(C1);
+    }
+
+    return 0;
+}
@@ -7,6 +7,7 @@
 
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include <stdio.h>
 #include <math.h>
 #include <limits.h>
@@ -14,6 +15,12 @@
 
 #include "include/gemmini_params.h"
 
+// Host-side (CPU mode) kernels use RVV when the core has it and elements are integers
+#if defined(__riscv_vector) && !defined(ELEM_T_IS_FLOAT)
+#include <riscv_vector.h>
+#define GEMMINI_CPU_RVV
+#endif
+
 #define GEMMINI_ASSERTIONS
 
 // Accelerator interface
@@ -920,6 +927,36 @@ static elem_t scale_and_sat(acc_t x, int act, acc_scale_t scale, acc_scale_t ber
 #define GEMMINI_ACC_SCALE(x, scale) (x)
 #endif
 
+// CPU counterpart of a full_C matmul: the raw accumulators are written out as
+// acc_t, without activation or output scaling, like an mvout of the accumulator
+static void matmul_cpu_full_C(bool transA, bool transB, size_t DIM_I, size_t DIM_J, size_t DIM_K,
+        const elem_t* A, const elem_t* B, const acc_t * D,
+        acc_t* C,
+        size_t stride_A, size_t stride_B, size_t stride_D, size_t stride_C,
+        scale_t A_scale_factor, scale_t B_scale_factor, scale_acc_t D_scale_factor,
+        bool repeating_bias) {
+
+  const int no_bias = D == NULL;
+  const size_t A_dim_strides[2] = {!transA ? stride_A : 1, !transA ? 1 : stride_A}; // i, k stride
+  const size_t B_dim_strides[2] = {!transB ? 1 : stride_B, !transB ? stride_B : 1}; // j, k stride
+
+  for (size_t i = 0; i < DIM_I; i++) {
+    acc_t * c = C + i * stride_C;
+    const size_t bias_row = repeating_bias ? 0 : i;
+
+    for (size_t j = 0; j < DIM_J; j++)
+      c[j] = no_bias ? 0 : GEMMINI_ACC_SCALE(*(D + bias_row * stride_D + j), D_scale_factor);
+
+    for (size_t k = 0; k < DIM_K; k++) {
+      const acc_t a = GEMMINI_SCALE(*(A + i * A_dim_strides[0] + k * A_dim_strides[1]), A_scale_factor);
+      const elem_t * b = B + k * B_dim_strides[1];
+
+      for (size_t j = 0; j < DIM_J; j++)
+        c[j] += a * GEMMINI_SCALE(*(b + j * B_dim_strides[0]), B_scale_factor);
+    }
+  }
+}
+
 static void matmul_cpu(bool transA, bool transB, size_t DIM_I, size_t DIM_J, size_t DIM_K,
         const elem_t* A, const elem_t* B, const acc_t * D,
         elem_t* C,
@@ -1233,6 +1270,12 @@ static void tiled_matmul(size_t dim_I, size_t dim_J, size_t dim_K,
         full_C, low_D,
         weightA,
         (int)tiled_matmul_type);
+  } else if (full_C) {
+    matmul_cpu_full_C(transpose_A, transpose_B, dim_I, dim_J, dim_K,
+            A, B, (const acc_t*) D, (acc_t*)C,
+            stride_A, stride_B, stride_D, stride_C,
+            A_scale_factor, B_scale_factor, D_scale_factor,
+            repeating_bias);
   } else /*if (tiled_matmul_type == CPU)*/ {
     matmul_cpu(transpose_A, transpose_B, dim_I, dim_J, dim_K,
             A, B, (const acc_t*) D, (elem_t*)C,
@@ -1857,12 +1900,22 @@ static int tiled_conv_total_spad_rows(bool acc,
 }
 
 
-static void conv_cpu_without_pool(
+// Output pixels lowered per im2col tile (a multiple of matmul_cpu's 4x4 block)
+#define CONV_CPU_IM2COL_ROWS 64
+
+// Implicit-GEMM lowering of the CPU conv. The weights are packed once into a
+// (kernel_dim * kernel_dim * in_channels) x out_channels panel, and output pixels
+// are lowered CONV_CPU_IM2COL_ROWS at a time into im2col rows which go through
+// matmul_cpu. Padding and input-dilation holes become zeros in the im2col rows,
+// and wrot180 / trans_weight_* are resolved while packing, so every output is the
+// same integer sum the direct loops produced. Results are written in NHWC pixel
+// order with out_stride; trans_output_1203 and pooling are handled by the callers.
+static void conv_cpu_gemm(
         int batch_size, int in_row_dim, int in_col_dim, int in_channels,
         int out_channels, int out_row_dim, int out_col_dim,
         int stride, int input_dilation, int kernel_dilation, int padding, int kernel_dim,
         int in_stride, int weight_stride, int out_stride,
-        bool wrot180, bool trans_output_1203, bool trans_input_3120,
+        bool wrot180, bool trans_input_3120,
         bool trans_weight_1203, bool trans_weight_0132,
 
         const elem_t * input,
@@ -1872,68 +1925,139 @@ static void conv_cpu_without_pool(
 
         int act, acc_scale_t scale) {
 
-  bool no_bias = bias == NULL;
+  const size_t patch = (size_t)kernel_dim * kernel_dim * in_channels;
 
-  for (int b = 0; b < batch_size; b++) {
-    for (int orow = 0; orow < out_row_dim; orow++) {
-      for (int ocol = 0; ocol < out_col_dim; ocol++) {
-        for (int och = 0; och < out_channels; och++) {
+  elem_t * wpanel = (elem_t *) malloc(patch * out_channels * sizeof(elem_t));
+  elem_t * cols = (elem_t *) malloc((size_t)CONV_CPU_IM2COL_ROWS * patch * sizeof(elem_t));
 
-          acc_t opixel = no_bias ? 0 : bias[och];
+  for (int krow = 0; krow < kernel_dim; krow++) {
+    for (int kcol = 0; kcol < kernel_dim; kcol++) {
+      const int krow_ = wrot180 ? kernel_dim - krow - 1 : krow;
+      const int kcol_ = wrot180 ? kernel_dim - kcol - 1 : kcol;
 
-          for (int krow = 0; krow < kernel_dim; krow++) {
-            if ((orow * stride + krow * kernel_dilation - padding) % input_dilation != 0)
-              continue;
+      for (int kch = 0; kch < in_channels; kch++) {
+        elem_t * w = wpanel + ((size_t)(krow * kernel_dim + kcol) * in_channels + kch) * out_channels;
 
-            const int irow = (orow * stride + krow * kernel_dilation - padding) / input_dilation;
+        for (int och = 0; och < out_channels; och++) {
+          if (trans_weight_1203) {
+            // HWIO to WIHO
+            w[och] = *(weights + (kch * kernel_dim * kernel_dim  + krow_ * kernel_dim + kcol_) * out_channels + och);
+          } else if (trans_weight_0132) {
+            // HWIO to HWOI
+            w[och] = *(weights + (krow_ * kernel_dim * out_channels + kcol_ * out_channels + och) * in_channels + kch);
+          } else {
+            w[och] = *(weights + (krow_ * kernel_dim * in_channels + kcol_ * in_channels + kch) * weight_stride + och);
+          }
+        }
+      }
+    }
+  }
 
-            for (int kcol = 0; kcol < kernel_dim; kcol++) {
-              if ((ocol * stride + kcol * kernel_dilation - padding) % input_dilation != 0)
-                continue;
+  const int out_pixels = batch_size * out_row_dim * out_col_dim;
 
-              const int icol = (ocol * stride + kcol * kernel_dilation - padding) / input_dilation;
+  for (int p0 = 0; p0 < out_pixels; p0 += CONV_CPU_IM2COL_ROWS) {
+    const int rows = out_pixels - p0 < CONV_CPU_IM2COL_ROWS ? out_pixels - p0 : CONV_CPU_IM2COL_ROWS;
 
-              for (int kch = 0; kch < in_channels; kch++) {
-                const elem_t *in = input + (b * in_row_dim * in_col_dim + irow * in_col_dim + icol) * in_stride + kch;
-                if (trans_input_3120) {
-                  // NHWC to CHWN
-                  in = input + (kch * in_row_dim * in_col_dim + irow * in_col_dim + icol) * batch_size + b;
-                }
+    for (int r = 0; r < rows; r++) {
+      const int p = p0 + r;
+      const int b = p / (out_row_dim * out_col_dim);
+      const int orow = (p / out_col_dim) % out_row_dim;
+      const int ocol = p % out_col_dim;
 
-                elem_t ipixel = irow < 0 || irow >= in_row_dim || icol < 0 || icol >= in_col_dim ?
-                    0 : *in;
+      elem_t * col = cols + (size_t)r * patch;
 
-                const int krow_ = wrot180 ? kernel_dim - krow - 1 : krow;
-                const int kcol_ = wrot180 ? kernel_dim - kcol - 1 : kcol;
+      for (int krow = 0; krow < kernel_dim; krow++) {
+        const int irow_ = orow * stride + krow * kernel_dilation - padding;
+        const int irow = irow_ / input_dilation;
+        const bool row_valid = irow_ % input_dilation == 0 && irow >= 0 && irow < in_row_dim;
 
-                elem_t weight = *(weights + (krow_ * kernel_dim * in_channels + kcol_ * in_channels + kch) * weight_stride + och);
-                if (trans_weight_1203) {
-                  // HWIO to WIHO
-                  weight = *(weights + (kch * kernel_dim * kernel_dim  + krow_ * kernel_dim + kcol_) * out_channels + och);
-                } else if (trans_weight_0132) {
-                  // HWIO to HWOI
-                  weight = *(weights + (krow_ * kernel_dim * out_channels + kcol_ * out_channels + och) * in_channels + kch);
-                }
+        for (int kcol = 0; kcol < kernel_dim; kcol++) {
+          const int icol_ = ocol * stride + kcol * kernel_dilation - padding;
+          const int icol = icol_ / input_dilation;
+          const bool valid = row_valid && icol_ % input_dilation == 0 && icol >= 0 && icol < in_col_dim;
 
-                opixel += weight * ipixel;
-              }
-            }
-          }
+          elem_t * c = col + (size_t)(krow * kernel_dim + kcol) * in_channels;
 
-          elem_t *out = output + (b * out_row_dim * out_col_dim + orow * out_col_dim + ocol) * out_stride + och;
-          if (trans_output_1203) {
-            // NHWC to HWNC
-            out = output + (orow * out_col_dim * batch_size + ocol * batch_size + b) * out_channels + och;
+          if (!valid) {
+            memset(c, 0, in_channels * sizeof(elem_t));
+          } else if (trans_input_3120) {
+            // NHWC to CHWN
+            for (int kch = 0; kch < in_channels; kch++)
+              c[kch] = *(input + (kch * in_row_dim * in_col_dim + irow * in_col_dim + icol) * batch_size + b);
+          } else {
+            memcpy(c, input + (size_t)(b * in_row_dim * in_col_dim + irow * in_col_dim + icol) * in_stride,
+                in_channels * sizeof(elem_t));
           }
-
-          *out = scale_and_sat(opixel, act, scale, 0);
         }
       }
     }
+
+    matmul_cpu(false, false, rows, out_channels, patch,
+        cols, wpanel, bias, output + (size_t)p0 * out_stride,
+        patch, out_channels, 0, out_stride,
+        MVIN_SCALE_IDENTITY, MVIN_SCALE_IDENTITY, MVIN_SCALE_IDENTITY,
+        act, scale, 0, true);
+  }
+
+  free(cols);
+  free(wpanel);
+}
+
+
+static void conv_cpu_without_pool(
+        int batch_size, int in_row_dim, int in_col_dim, int in_channels,
+        int out_channels, int out_row_dim, int out_col_dim,
+        int stride, int input_dilation, int kernel_dilation, int padding, int kernel_dim,
+        int in_stride, int weight_stride, int out_stride,
+        bool wrot180, bool trans_output_1203, bool trans_input_3120,
+        bool trans_weight_1203, bool trans_weight_0132,
+
+        const elem_t * input,
+        const elem_t * weights,
+        const acc_t * bias,
+        elem_t * output,
+
+        int act, acc_scale_t scale) {
+
+  if (!trans_output_1203) {
+    conv_cpu_gemm(
+        batch_size, in_row_dim, in_col_dim, in_channels,
+        out_channels, out_row_dim, out_col_dim,
+        stride, input_dilation, kernel_dilation, padding, kernel_dim,
+        in_stride, weight_stride, out_stride,
+        wrot180, trans_input_3120, trans_weight_1203, trans_weight_0132,
+        input, weights, bias, output,
+        act, scale);
+    return;
   }
+
+  // NHWC to HWNC : compute densely, then scatter
+  const size_t out_pixels = (size_t)batch_size * out_row_dim * out_col_dim;
+  elem_t * tmp = (elem_t *) malloc(out_pixels * out_channels * sizeof(elem_t));
+
+  conv_cpu_gemm(
+      batch_size, in_row_dim, in_col_dim, in_channels,
+      out_channels, out_row_dim, out_col_dim,
+      stride, input_dilation, kernel_dilation, padding, kernel_dim,
+      in_stride, weight_stride, out_channels,
+      wrot180, trans_input_3120, trans_weight_1203, trans_weight_0132,
+      input, weights, bias, tmp,
+      act, scale);
+
+  for (int b = 0; b < batch_size; b++)
+    for (int orow = 0; orow < out_row_dim; orow++)
+      for (int ocol = 0; ocol < out_col_dim; ocol++)
+        memcpy(output + (orow * out_col_dim * batch_size + ocol * batch_size + b) * out_channels,
+            tmp + (size_t)(b * out_row_dim * out_col_dim + orow * out_col_dim + ocol) * out_channels,
+            out_channels * sizeof(elem_t));
+
+  free(tmp);
 }
 
 
+// Number of channels whose accumulators are kept live per output pixel
+#define CONV_DW_CPU_CH_TILE 256
+
 static void conv_dw_cpu_without_pool(
         int batch_size, int in_row_dim, int in_col_dim,
         int channels, int out_row_dim, int out_col_dim,
@@ -1948,36 +2072,74 @@ static void conv_dw_cpu_without_pool(
 
   bool no_bias = bias == NULL;
 
-  for (int b = 0; b < batch_size; b++) {
-    for (int orow = 0; orow < out_row_dim; orow++) {
-      for (int ocol = 0; ocol < out_col_dim; ocol++) {
-        for (int ch = 0; ch < channels; ch++) {
-          acc_t opixel = no_bias ? 0 : bias[ch];
+  // Weights are stored [ch][krow][kcol]. Repack them once to [krow][kcol][ch]
+  // so that, like the NHWC input, every tap is a unit-stride run of channels
+  const int kernel_area = kernel_dim * kernel_dim;
+  elem_t * wt = (elem_t *) malloc((size_t)kernel_area * channels * sizeof(elem_t));
+  for (int ch = 0; ch < channels; ch++)
+    for (int k = 0; k < kernel_area; k++)
+      wt[(size_t)k * channels + ch] = weights[(size_t)ch * kernel_area + k];
 
-          for (int krow = 0; krow < kernel_dim; krow++) {
-            const int irow = orow * stride + krow - padding;
+  acc_t opixel[CONV_DW_CPU_CH_TILE];
 
-            for (int kcol = 0; kcol < kernel_dim; kcol++) {
-              const int icol = ocol * stride + kcol - padding;
-
-              const elem_t * in = input + (b * in_row_dim * in_col_dim + irow * in_col_dim + icol) * channels + ch;
-
-              const elem_t ipixel = irow < 0 || irow >= in_row_dim || icol < 0 || icol >= in_col_dim ?
-                  0 : *in;
-
-              const elem_t weight = *(weights + (ch * kernel_dim + krow) * kernel_dim  + kcol);
+  for (int b = 0; b < batch_size; b++) {
+    for (int orow = 0; orow < out_row_dim; orow++) {
+      // Only the taps that land inside the input contribute, so the padding
+      // checks are hoisted out of the channel loop
+      const int irow0 = orow * stride - padding;
+      const int krow_start = irow0 < 0 ? -irow0 : 0;
+      const int krow_end = in_row_dim - irow0 < kernel_dim ? in_row_dim - irow0 : kernel_dim;
 
-              opixel += weight * ipixel;
+      for (int ocol = 0; ocol < out_col_dim; ocol++) {
+        const int icol0 = ocol * stride - padding;
+        const int kcol_start = icol0 < 0 ? -icol0 : 0;
+        const int kcol_end = in_col_dim - icol0 < kernel_dim ? in_col_dim - icol0 : kernel_dim;
+
+        elem_t * out = output + ((size_t)(b * out_row_dim + orow) * out_col_dim + ocol) * channels;
+
+        for (int ch0 = 0; ch0 < channels; ch0 += CONV_DW_CPU_CH_TILE) {
+          const int chs = channels - ch0 < CONV_DW_CPU_CH_TILE ?
+            channels - ch0 : CONV_DW_CPU_CH_TILE;
+
+          for (int ch = 0; ch < chs; ch++)
+            opixel[ch] = no_bias ? 0 : bias[ch0 + ch];
+
+          for (int krow = krow_start; krow < krow_end; krow++) {
+            const int irow = irow0 + krow;
+
+            for (int kcol = kcol_start; kcol < kcol_end; kcol++) {
+              const int icol = icol0 + kcol;
+
+              const elem_t * in = input + ((size_t)(b * in_row_dim + irow) * in_col_dim + icol) * channels + ch0;
+              const elem_t * w = wt + (size_t)(krow * kernel_dim + kcol) * channels + ch0;
+
+#ifdef GEMMINI_CPU_RVV
+              if (sizeof(elem_t) == sizeof(int8_t) && sizeof(acc_t) == sizeof(int32_t)) {
+                for (int ch = 0; ch < chs;) {
+                  const size_t vl = __riscv_vsetvl_e32m8(chs - ch);
+                  vint16m4_t vprod = __riscv_vwmul_vv_i16m4(
+                      __riscv_vle8_v_i8m2((const int8_t *)in + ch, vl),
+                      __riscv_vle8_v_i8m2((const int8_t *)w + ch, vl), vl);
+                  vint32m8_t vacc = __riscv_vle32_v_i32m8((const int32_t *)opixel + ch, vl);
+                  __riscv_vse32_v_i32m8((int32_t *)opixel + ch, __riscv_vwadd_wv_i32m8(vacc, vprod, vl), vl);
+                  ch += vl;
+                }
+                continue;
+              }
+#endif
+              for (int ch = 0; ch < chs; ch++)
+                opixel[ch] += (acc_t)w[ch] * in[ch];
             }
           }
 
-          elem_t *out = output + (b * out_row_dim * out_col_dim + orow * out_col_dim + ocol) * channels + ch;
-
-          *out = scale_and_sat(opixel, act, scale, 0);
+          for (int ch = 0; ch < chs; ch++)
+            out[ch0 + ch] = scale_and_sat(opixel[ch], act, scale, 0);
         }
       }
     }
   }
+
+  free(wt);
 }
 
 
@@ -2011,15 +2173,33 @@ static void conv_cpu(
     return;
   }
 
-  const bool no_bias = bias == NULL;
   const int pool_out_row_dim = (out_row_dim + 2 * pool_padding - pool_size) / pool_stride + 1;
   const int pool_out_col_dim = (out_col_dim + 2 * pool_padding - pool_size) / pool_stride + 1;
 
+  // The pooled conv recomputed every output pixel once per pooling window it
+  // falls in. Compute the conv once, then max-pool the saturated results
+  const size_t out_pixels = (size_t)batch_size * out_row_dim * out_col_dim;
+  elem_t * conv_out = (elem_t *) malloc(out_pixels * out_channels * sizeof(elem_t));
+
+  conv_cpu_gemm(
+      batch_size, in_row_dim, in_col_dim, in_channels,
+      out_channels, out_row_dim, out_col_dim,
+      stride, input_dilation, kernel_dilation, padding, kernel_dim,
+      in_stride, weight_stride, out_channels,
+      wrot180, trans_input_3120, trans_weight_1203, trans_weight_0132,
+      input, weights, bias, conv_out,
+      act, scale);
+
   for (int b = 0; b < batch_size; b++) {
     for (int porow = 0; porow < pool_out_row_dim; porow++) {
       for (int pocol = 0; pocol < pool_out_col_dim; pocol++) {
-        for (int poch = 0; poch < out_channels; poch++) {
+        elem_t * out = output + (b * pool_out_row_dim * pool_out_col_dim + porow * pool_out_col_dim + pocol) * out_stride;
+        if (trans_output_1203) {
+          // NHWC to HWNC
+          out = output + (porow * pool_out_col_dim * batch_size + pocol * batch_size + b) * out_channels;
+        }
 
+        for (int poch = 0; poch < out_channels; poch++) {
           elem_t running_max = 0;
           bool running_max_initialized = false;
 
@@ -2035,70 +2215,22 @@ static void conv_cpu(
                   running_max_initialized = true;
                 }
               } else {
-
-                acc_t opixel = no_bias ? 0 : bias[poch];
-
-                for (int krow = 0; krow < kernel_dim; krow++) {
-                  if ((orow * stride + krow * kernel_dilation - padding) % input_dilation != 0)
-                    continue;
-
-                  const int irow = (orow * stride + krow * kernel_dilation - padding) / input_dilation;
-
-                  for (int kcol = 0; kcol < kernel_dim; kcol++) {
-                    if ((ocol * stride + kcol * kernel_dilation - padding) % input_dilation != 0)
-                      continue;
-
-                    const int icol = (ocol * stride + kcol * kernel_dilation - padding) / input_dilation;
-
-                    for (int kch = 0; kch < in_channels; kch++) {
-                      const elem_t * in = input + (b * in_row_dim * in_col_dim + irow * in_col_dim + icol) * in_stride + kch;
-                      if (trans_input_3120) {
-                        // NHWC to CHWN
-                        in = input + (kch * in_row_dim * in_col_dim + irow * in_col_dim + icol) * batch_size + b;
-                      }
-
-                      elem_t ipixel = irow < 0 || irow >= in_row_dim || icol < 0 || icol >= in_col_dim ?
-                          0 : *in;
-
-                      const int krow_ = wrot180 ? kernel_dim - krow - 1 : krow;
-                      const int kcol_ = wrot180 ? kernel_dim - kcol - 1 : kcol;
-
-                      elem_t weight = *(weights + (krow_ * kernel_dim * in_channels + kcol_ * in_channels + kch) * weight_stride + poch);
-                      if (trans_weight_1203) {
-                        // HWIO to WIHO
-                        weight = *(weights + (kch * kernel_dim * kernel_dim  + krow_ * kernel_dim + kcol_) * out_channels + poch);
-                      } else if (trans_weight_0132) {
-                        // HWIO to HWOI
-                        weight = *(weights + (krow_ * kernel_dim * out_channels + kcol_ * out_channels + poch) * in_channels + kch);
-                      }
-
-                      opixel += weight * ipixel;
-                    }
-                  }
-                }
-
-                opixel = scale_and_sat(opixel, act, scale, 0);
+                const elem_t opixel = conv_out[(size_t)(b * out_row_dim * out_col_dim + orow * out_col_dim + ocol) * out_channels + poch];
                 if (!running_max_initialized || opixel > running_max) {
                   running_max = opixel;
                   running_max_initialized = true;
                 }
               }
-
-              if (pwrow == pool_size - 1 && pwcol == pool_size - 1) {
-                elem_t * out = output + (b * pool_out_row_dim * pool_out_col_dim + porow * pool_out_col_dim + pocol) * out_stride + poch;
-                if (trans_output_1203) {
-                  // NHWC to HWNC
-                  out = output + (porow * pool_out_col_dim * batch_size + pocol * batch_size + b) * out_channels + poch;
-                }
-
-                *out = running_max;
-              }
             }
           }
+
+          out[poch] = running_max;
         }
       }
     }
   }
+
+  free(conv_out);
 }
 
 
@@ -2892,7 +3024,9 @@ _STATIC void tiled_conv_auto(
 
 }
 
-// This function is for a convolution with kernel_dim=1, stride==2, padding=0, and no pooling
+// This function is for a convolution with kernel_dim=1, stride==2, padding=0, and no pooling.
+// Each output row is a single matmul over every other pixel of every other input row.
+// out_row_dim / out_col_dim must be ceil(in_row_dim / 2) / ceil(in_col_dim / 2)
 static void tiled_conv_downsample(
         int batch_size, int in_row_dim, int in_col_dim, int in_channels,
         int out_channels, int out_row_dim, int out_col_dim,
@@ -2907,31 +3041,27 @@ static void tiled_conv_downsample(
 
         enum tiled_matmul_type_t tiled_conv_type) {
 
-    // Rectangular dimensions for this function are currently not supported
-    if (in_row_dim != in_col_dim || out_row_dim != out_col_dim) {
-        printf("Rectangular convolutions for tiled_conv_downsample are currently not supported.\n");
+    const int stride = 2;
+
+    if (out_row_dim != (in_row_dim + stride - 1) / stride || out_col_dim != (in_col_dim + stride - 1) / stride) {
+        printf("tiled_conv_downsample: output dims must be the stride-2 input dims\n");
         exit(1);
     }
 
-    const int in_dim = in_row_dim;
-    const int out_dim = out_row_dim;
-
-    const int stride = 2;
-
     for (int b = 0; b < batch_size; b++) {
         for (int irow = 0; irow < in_row_dim; irow += stride) {
             const int orow = irow / stride;
 
-            const int I = in_col_dim / stride; // number of columns in row
+            const int I = out_col_dim; // number of columns in row
             const int J = out_channels;
             const int K = in_channels;
 
-            const elem_t * A = input + (b * in_dim + irow) * in_dim * in_stride;
+            const elem_t * A = input + ((size_t)b * in_row_dim + irow) * in_col_dim * in_stride;
             const elem_t * B = weights;
             const acc_t * D = bias;
-            elem_t * C = output + (b * out_dim + orow) * out_dim * out_stride;
+            elem_t * C = output + ((size_t)b * out_row_dim + orow) * out_col_dim * out_stride;
 
-            const int A_stride = in_stride * 2;
+            const int A_stride = in_stride * stride;
             const int B_stride = weight_stride;
             const int D_stride = out_stride;
             const int C_stride = out_stride;
@@ -3141,18 +3271,56 @@ static void resadd_cpu(const size_t I, const size_t J,
 
 	const int minimum = relu ? 0 : elem_t_min;
 
+#ifndef ELEM_T_IS_FLOAT
+    // With identity scales, MVIN_SCALE and ACC_SCALE leave integers untouched,
+    // so the whole operation is a saturating add which can be vectorized
+    const bool identity = A_scale == MVIN_SCALE_IDENTITY &&
+        B_scale == MVIN_SCALE_IDENTITY && C_scale == ACC_SCALE_IDENTITY;
+
+    if (identity) {
+        for (size_t i = 0; i < I; i++) {
+            const elem_t * a = A + i * stride;
+            const elem_t * b = B + i * stride;
+            elem_t * c = C + i * stride;
+
+#ifdef GEMMINI_CPU_RVV
+            if (sizeof(elem_t) == sizeof(int8_t)) {
+                for (size_t j = 0; j < J;) {
+                    const size_t vl = __riscv_vsetvl_e8m4(J - j);
+                    vint8m4_t va = __riscv_vle8_v_i8m4((const int8_t *)a + j, vl);
+                    vint8m4_t vb = __riscv_vle8_v_i8m4((const int8_t *)b + j, vl);
+                    vint8m4_t vc = __riscv_vsadd_vv_i8m4(va, vb, vl);
+                    if (relu)
+                        vc = __riscv_vmax_vx_i8m4(vc, 0, vl);
+                    __riscv_vse8_v_i8m4((int8_t *)c + j, vc, vl);
+                    j += vl;
+                }
+                continue;
+            }
+#endif
+            for (size_t j = 0; j < J; j++) {
+                acc_t result = (acc_t)a[j] + (acc_t)b[j];
+                result = result > elem_t_max ? elem_t_max :
+                    (result < minimum ? minimum : result);
+                c[j] = result;
+            }
+        }
+        return;
+    }
+#endif
+
     for (size_t i = 0; i < I; i++) {
-        for (size_t j = 0; j < J; j++) {
-            const elem_t * a = A + i * stride + j;
-            const elem_t * b = B + i * stride + j;
-            elem_t * c = C + i * stride + j;
+        const elem_t * a = A + i * stride;
+        const elem_t * b = B + i * stride;
+        elem_t * c = C + i * stride;
 
-            acc_t result = MVIN_SCALE(*a, A_scale) + MVIN_SCALE(*b, B_scale);
+        for (size_t j = 0; j < J; j++) {
+            acc_t result = MVIN_SCALE(a[j], A_scale) + MVIN_SCALE(b[j], B_scale);
             result = ACC_SCALE(result, C_scale);
             result = result > elem_t_max ? elem_t_max :
                 (result < minimum ? minimum : result);
 
-            *c = result;
+            c[j] = result;
         }
     }
 }
@@ -3282,26 +3450,61 @@ static void tiled_resadd_stride_auto(const size_t I, const size_t J,
         return;
     }
 
-    size_t tile_I = I, tile_J = J;
-
-    // size_t total_spad_rows = 2 * (tile_I / DIM + (tile_I % DIM != 0))*DIM * (tile_J / DIM + (tile_J % DIM != 0));
-    size_t total_acc_rows = (tile_I / DIM + (tile_I % DIM != 0))*DIM * (tile_J / DIM + (tile_J % DIM != 0));
+    if (I == 0 || J == 0)
+        return;
 
-    // TODO this is a very inefficient way of doing this...
-    while (total_acc_rows > ACC_ROWS / 2) {
-        //if(tile_J > MAX_BLOCK_LEN * DIM)
-        //    tile_J = MAX_BLOCK_LEN * DIM;
-        //else
-        if (tile_I >= tile_J || tile_J <= DIM)
-            tile_I /= 2;
-        else
-            tile_J -= DIM;
+    // Closed-form tiling. A and B are both moved into the accumulator and the
+    // scratchpad, and both are double-buffered, so each tile may use at most
+    // half of the smaller of the two memories.
+    //
+    // tile_J is chosen first, as wide as possible (and a multiple of
+    // MAX_BLOCK_LEN blocks when J has to be split) so that every row is moved
+    // in with full-length mvin bursts. tile_I then fills the remaining
+    // accumulator rows. Both are finally rebalanced so that the last tile is
+    // not much smaller than the others.
+    const size_t I_blocks = I / DIM + (I % DIM != 0);
+    const size_t J_blocks = J / DIM + (J % DIM != 0);
+
+    const size_t max_acc_rows = ACC_ROWS / 2;
+    const size_t max_spad_rows = (BANK_NUM * BANK_ROWS / 2) / 2;
+    const size_t max_rows = max_acc_rows < max_spad_rows ? max_acc_rows : max_spad_rows;
+    const size_t max_blocks = max_rows / DIM > 0 ? max_rows / DIM : 1;
+
+    size_t tile_J_blocks = J_blocks;
+    if (tile_J_blocks > max_blocks) {
+        tile_J_blocks = max_blocks >= MAX_BLOCK_LEN ?
+            (max_blocks / MAX_BLOCK_LEN) * MAX_BLOCK_LEN : max_blocks;
+
+        const size_t J_tiles = J_blocks / tile_J_blocks + (J_blocks % tile_J_blocks != 0);
+        size_t balanced = J_blocks / J_tiles + (J_blocks % J_tiles != 0);
+        if (balanced % MAX_BLOCK_LEN != 0 &&
+            (balanced / MAX_BLOCK_LEN + 1) * MAX_BLOCK_LEN <= tile_J_blocks)
+            balanced = (balanced / MAX_BLOCK_LEN + 1) * MAX_BLOCK_LEN;
+        tile_J_blocks = balanced;
+    }
 
-        total_acc_rows = (tile_I / DIM + (tile_I % DIM != 0))*DIM * (tile_J / DIM + (tile_J % DIM != 0));
+    size_t tile_I_blocks = max_blocks / tile_J_blocks;
+    if (tile_I_blocks < 1) tile_I_blocks = 1;
+    if (tile_I_blocks > I_blocks) tile_I_blocks = I_blocks;
+    if (tile_I_blocks > 65535) tile_I_blocks = 65535;
+    {
+        const size_t I_tiles = I_blocks / tile_I_blocks + (I_blocks % tile_I_blocks != 0);
+        tile_I_blocks = I_blocks / I_tiles + (I_blocks % I_tiles != 0);
     }
 
-    // printf("tile_I: %llu\n", tile_I);
-    // printf("tile_J: %llu\n", tile_J);
+    const size_t tile_I = tile_I_blocks * DIM < I ? tile_I_blocks * DIM : I;
+    const size_t tile_J = tile_J_blocks * DIM < J ? tile_J_blocks * DIM : J;
+
+#ifdef PRINT_TILE
+#if PRINT_TILE
+    {
+        const size_t acc_rows = tile_I_blocks * DIM * tile_J_blocks;
+        printf("tile_I: %zu\n", tile_I);
+        printf("tile_J: %zu\n", tile_J);
+        printf("acc_row utilization: %zu%%\n\n", (acc_rows * 100) / max_acc_rows);
+    }
+#endif
+#endif
 
     if (matadd_type == WS) {
       tiled_resadd(I, J, stride, tile_I, tile_J,
@@ -3330,26 +3533,52 @@ _STATIC void tiled_resadd_auto(const size_t I, const size_t J,
         relu, matadd_type);
 }
 
+// Number of channels whose running sums are kept live while streaming pixels
+#define GLOBAL_AVERAGE_CPU_CH_TILE 256
+
 static void global_average_cpu(const elem_t * input, elem_t * output,
     int batches, int channels, int dim) {
   const int count = dim * dim;
 
-  for (int batch = 0; batch < batches; batch++) {
-    for (int channel = 0; channel < channels; channel++) {
-      acc_t sum = 0;
-      for (int row = 0; row < dim; row++) {
-        for (int col = 0; col < dim; col++) {
-          size_t pixel = batch * dim * dim + row * dim + col;
+  // Pixels are streamed in NHWC order and each pixel's channels are
+  // accumulated contiguously, so every load is unit-stride
+  acc_t sums[GLOBAL_AVERAGE_CPU_CH_TILE];
 
-          sum += input[pixel * channels + channel];
+  for (int batch = 0; batch < batches; batch++) {
+    for (int ch0 = 0; ch0 < channels; ch0 += GLOBAL_AVERAGE_CPU_CH_TILE) {
+      const int chs = channels - ch0 < GLOBAL_AVERAGE_CPU_CH_TILE ?
+        channels - ch0 : GLOBAL_AVERAGE_CPU_CH_TILE;
+
+      for (int ch = 0; ch < chs; ch++)
+        sums[ch] = 0;
+
+      for (int pixel = 0; pixel < count; pixel++) {
+        const elem_t * in = input + ((size_t)batch * count + pixel) * channels + ch0;
+
+#ifdef GEMMINI_CPU_RVV
+        if (sizeof(elem_t) == sizeof(int8_t) && sizeof(acc_t) == sizeof(int32_t)) {
+          for (int ch = 0; ch < chs;) {
+            const size_t vl = __riscv_vsetvl_e32m8(chs - ch);
+            vint32m8_t vin = __riscv_vsext_vf4_i32m8(__riscv_vle8_v_i8m2((const int8_t *)in + ch, vl), vl);
+            vint32m8_t vsum = __riscv_vle32_v_i32m8((const int32_t *)sums + ch, vl);
+            __riscv_vse32_v_i32m8((int32_t *)sums + ch, __riscv_vadd_vv_i32m8(vsum, vin, vl), vl);
+            ch += vl;
+          }
+          continue;
         }
+#endif
+        for (int ch = 0; ch < chs; ch++)
+          sums[ch] += in[ch];
       }
 
+      elem_t * out = output + batch * channels + ch0;
+      for (int ch = 0; ch < chs; ch++) {
 #ifdef ELEM_T_IS_FLOAT
-      output[batch * channels + channel] = sum / count;
+        out[ch] = sums[ch] / count;
 #else
-      output[batch * channels + channel] = (sum + count/2) / count;
+        out[ch] = (sums[ch] + count/2) / count;
 #endif
+      }
     }
   }
 }
@@ -0,0 +1,166 @@
+// ggml-gemmini-batch.cpp
+#include "ggml-gemmini-batch.h"
+#include "ggml-gemmini-tensor.h"
+#include "ggml-gemmini-gemv.h"
+#include "ggml-gemmini-split.h"
+#include "gemmini.h"
+
+#include <chrono>
+#include <optional>
+
+using namespace zerogod;
+
+// leader 가 다른 graph 의 합류를 기다리는 최대 시간 (us)
+#ifndef GGML_GEMMINI_BATCH_WAIT_US
+#define GGML_GEMMINI_BATCH_WAIT_US 200
+#endif
+
+std::shared_ptr<ggml_gemmini_batcher> ggml_gemmini_batcher::shared()
+{
+    static std::shared_ptr<ggml_gemmini_batcher> instance = std::make_shared<ggml_gemmini_batcher>();
+    return instance;
+}
+
+int ggml_gemmini_batcher::enter(const std::vector<const ggml_tensor *> &ws)
+{
+    std::lock_guard<std::mutex> lk(mtx_);
+    const int id = next_id_++;
+    graph_state &g = graphs_[id];
+    for (const ggml_tensor *w : ws)
+        g.ws.emplace_back(w, w->data);
+    return id;
+}
+
+void ggml_gemmini_batcher::leave(int graph)
+{
+    std::lock_guard<std::mutex> lk(mtx_);
+    graphs_.erase(graph);
+    cv_.notify_all(); // 이 graph 를 기다리던 leader 가 다시 확인
+}
+
+bool ggml_gemmini_batcher::expected(int graph, const key_t &key) const
+{
+    for (const auto &[id, g] : graphs_)
+        if (id != graph && !g.waiting && g.next < g.ws.size() && g.ws[g.next] == key)
+            return true;
+    return false;
+}
+
+void ggml_gemmini_batcher::mul_mat(ggml_backend_gemmini_context *ctx, int graph, const ggml_tensor *w, const request &req)
+{
+    const key_t key(w, w->data);
+
+    std::unique_lock<std::mutex> lk(mtx_);
+
+    // 이 graph 의 다음 위치를 w 뒤로
+    graph_state &g = graphs_.at(graph);
+    while (g.next < g.ws.size())
+        if (g.ws[g.next++] == key)
+            break;
+
+    auto it = open_.find(key);
+    if (it != open_.end()) {
+        // 이미 열린 batch 에 합류
+        std::shared_ptr<batch> b = it->second;
+        b->reqs.push_back(&req);
+        cv_.notify_all();
+        cv_.wait(lk, [&] { return b->done; });
+        return;
+    }
+
+    // w 가 다음 차례인 graph 가 없으면 기다리지 않고 혼자 실행
+    if (!expected(graph, key)) {
+        lk.unlock();
+        ggml_backend_gemmini_mul_mat_i8(ctx, w, req);
+        return;
+    }
+
+    std::shared_ptr<batch> b = std::make_shared<batch>();
+    open_[key] = b;
+    b->reqs.push_back(&req);
+
+    // 기다리던 graph 가 모두 합류 (또는 끝남) 하거나 시간이 다 되면 마감 (이후 도착은 새 batch)
+    //   서로 상대의 weight 에서 기다리는 일이 없도록 대기 중임을 알림
+    g.waiting = true;
+    cv_.notify_all();
+    cv_.wait_for(lk, std::chrono::microseconds(GGML_GEMMINI_BATCH_WAIT_US),
+                 [&] { return !expected(graph, key); });
+    g.waiting = false;
+    open_.erase(key);
+    lk.unlock();
+
+    DBG("[Gemmini] batch: %s x %zu graphs\n", w->name, b->reqs.size());
+
+    if (b->reqs.size() == 1) {
+        ggml_backend_gemmini_mul_mat_i8(ctx, w, req);
+    } else {
+        // 요청들의 A / D 행을 이어 붙여 한 번에 계산하고 C 행을 나눠 돌려줌
+        const size_t K = w->ne[0], J = w->ne[1];
+        size_t I = 0;
+        bool has_d = false;
+        for (const request *r : b->reqs) {
+            I += r->I;
+            has_d = has_d || r->D;
+        }
+
+        ggml_gemmini_tensor<int8_t> tA(ctx->tmp_ctx, w->name, I, K);
+        ggml_gemmini_tensor<int8_t> tC(ctx->tmp_ctx, w->name, I, J);
+        std::optional<ggml_gemmini_tensor<int32_t>> tD;
+        if (has_d)
+            tD.emplace(ctx->tmp_ctx, w->name, I, J);
+
+        int8_t *A = static_cast<int8_t *>(tA.get());
+        const size_t sA = tA.get_stride();
+        size_t i0 = 0;
+        for (const request *r : b->reqs) {
+            for (size_t i = 0; i < r->I; i++) {
+                std::memcpy(A + (i0 + i) * sA, r->A + i * r->sA, K);
+                if (tD && r->D) {
+                    int32_t *D = static_cast<int32_t *>(tD->get()) + (i0 + i) * tD->get_stride();
+                    std::memcpy(D, r->D + (r->repeating ? 0 : i * r->sD), J * sizeof(int32_t));
+                }
+            }
+            i0 += r->I;
+        }
+
+        int8_t *C = static_cast<int8_t *>(tC.get());
+        const size_t sC = tC.get_stride();
+        ggml_backend_gemmini_mul_mat_i8(ctx, w, {A, sA, I,
+                                                 tD ? static_cast<const int32_t *>(tD->get()) : nullptr,
+                                                 tD ? tD->get_stride() : 0, false,
+                                                 C, sC});
+
+        i0 = 0;
+        for (const request *r : b->reqs) {
+            for (size_t i = 0; i < r->I; i++)
+                std::memcpy(r->C + i * r->sC, C + (i0 + i) * sC, J);
+            i0 += r->I;
+        }
+    }
+
+    lk.lock();
+    b->done = true;
+    cv_.notify_all();
+}
+
+void ggml_backend_gemmini_mul_mat_i8(ggml_backend_gemmini_context *ctx, const ggml_tensor *w,
+                                     const ggml_gemmini_batcher::request &req)
+{
+    if (ggml_backend_gemmini_gemv_preferred(ctx, w, req.I)) {
+        ggml_backend_gemmini_gemv(ctx, w, req.A, req.sA, req.I, req.D, req.sD, req.repeating, req.C, req.sC);
+        return;
+    }
+
+    const size_t K = w->ne[0], J = w->ne[1];
+    std::optional<ggml_gemmini_tensor<int8_t>> local;
+    const ggml_gemmini_tensor<int8_t> &tB = ctx->weight_cache->stage(ctx->tmp_ctx, w, GEMMINI_LAYOUT_MUL_MAT, local,
+                                                                     [&](ggml_context *c) {
+        return ggml_gemmini_tensor<int8_t>(c, w, ".i8", false, true);
+    });
+
+    ggml_backend_gemmini_tiled_matmul(ctx, req.I, J, K,
+                                      req.A, req.sA,
+                                      static_cast<const int8_t *>(tB.get()), tB.get_stride(),
+                                      req.D, req.sD, req.repeating,
+                                      req.C, req.sC);
+}
@@ -0,0 +1,85 @@
+// ggml-gemmini-batch.h
+#ifndef __GGML_GEMMINI_BATCH_H__
+#define __GGML_GEMMINI_BATCH_H__
+
+#include "ggml.h"
+#include "ggml-gemmini-util.h"
+
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// batching 대상 MUL_MAT 의 최대 token 수 (prefill 처럼 큰 I 는 묶어도 이득이 없고 기다리게만 함)
+#ifndef GGML_GEMMINI_BATCH_MAX_I
+#define GGML_GEMMINI_BATCH_MAX_I 16
+#endif
+
+namespace zerogod
+{
+    // continuous batching : 여러 backend (sequence 별) 가 동시에 실행하는 graph 사이에서
+    // 같은 weight 를 쓰는 MUL_MAT 을 모아 token 축 (I) 으로 이어 붙인 matmul 한 번으로 실행
+    //   graph 마다 batching 대상 weight 를 실행 순서대로 등록해 두고, 먼저 도착한 요청은
+    //   다음 차례로 같은 weight 에 도달할 다른 graph 가 있을 때만 잠시 합류를 기다림
+    class ggml_gemmini_batcher
+    {
+    public:
+        // 요청 하나 : A (I x K int8) 와 optional D 를 받아 C (I x J int8) 를 채움
+        struct request
+        {
+            const int8_t *A;
+            size_t sA, I;
+            const int32_t *D; // nullptr 이면 bias 없음
+            size_t sD;
+            bool repeating;   // D 가 1 행 bias
+            int8_t *C;
+            size_t sC;
+        };
+
+        // backend 전체가 공유하는 인스턴스
+        static std::shared_ptr<ggml_gemmini_batcher> shared();
+
+        // graph_compute 시작 : batcher 로 보낼 MUL_MAT 의 weight 를 실행 순서대로 등록, graph id 반환
+        int enter(const std::vector<const ggml_tensor *> &ws);
+        // graph_compute 끝 : 남은 weight 에 대해서는 더 이상 이 graph 를 기다리지 않음
+        void leave(int graph);
+
+        // graph 가 w 에 도달 : 다른 graph 의 다음 weight 도 w 면 합류를 기다려 묶어 실행,
+        // 아니면 바로 혼자 실행하고 req.C 가 채워지면 반환
+        void mul_mat(ggml_backend_gemmini_context *ctx, int graph, const ggml_tensor *w, const request &req);
+
+    private:
+        using key_t = std::pair<const ggml_tensor *, const void *>;
+
+        struct batch
+        {
+            std::vector<const request *> reqs;
+            bool done = false;
+        };
+
+        // 등록한 weight 와 다음에 도달할 위치
+        struct graph_state
+        {
+            std::vector<key_t> ws;
+            size_t next = 0;
+            bool waiting = false; // leader 로 합류를 기다리는 중 (그동안 다른 weight 에 도달할 수 없음)
+        };
+
+        // graph 외의 graph 중 다음 weight 가 key 이고 거기에 도달할 수 있는 것이 있는지 (mtx_ 를 잡은 상태)
+        bool expected(int graph, const key_t &key) const;
+
+        std::mutex mtx_;
+        std::condition_variable cv_;
+        int next_id_ = 0;
+        std::map<int, graph_state> graphs_;
+        std::map<key_t, std::shared_ptr<batch>> open_;
+    };
+}
+
+// A (I x K int8) * w^T (+ D) -> C (I x J int8) : cost model 로 host GEMV / Gemmini 중 선택
+void ggml_backend_gemmini_mul_mat_i8(ggml_backend_gemmini_context *ctx, const ggml_tensor *w,
+                                     const zerogod::ggml_gemmini_batcher::request &req);
+
+#endif // __GGML_GEMMINI_BATCH_H__
@@ -0,0 +1,764 @@
+// ggml-gemmini-conv.cpp
+#include "ggml-gemmini-conv.h"
+#include "ggml-gemmini-tensor.h"
+#include "ggml-gemmini-device.h"
+#include "gemmini.h"
+
+#include <optional>
+#include <vector>
+#include <cmath>
+
+using namespace zerogod;
+
+namespace
+{
+    // Gemmini conv 한 번에 필요한 shape (정사각 kernel, 가로/세로 동일 stride/padding/dilation)
+    struct conv_shape
+    {
+        int batch = 0, in_rows = 0, in_cols = 0, in_channels = 0;
+        int out_channels = 0, out_rows = 0, out_cols = 0;
+        int stride = 1, padding = 0, dilation = 1, kernel_dim = 1;
+        int input_dilation = 1;
+        bool transposed = false; // transposed conv : kernel [KW, KH, OC, IC], wrot180
+    };
+
+    // ggml 텐서를 (n, c, h, w) 좌표로 접근하기 위한 byte stride
+    struct nchw_view
+    {
+        char *data;
+        ggml_type type;
+        size_t nb_w, nb_h, nb_c, nb_n;
+
+        char *at(int64_t n, int64_t c, int64_t h, int64_t w) const
+        {
+            return data + n * nb_n + c * nb_c + h * nb_h + w * nb_w;
+        }
+    };
+
+    // ggml 기본 layout [W, H, C, N]
+    static nchw_view view_whcn(const ggml_tensor *t)
+    {
+        return {(char *)t->data, t->type, t->nb[0], t->nb[1], t->nb[2], t->nb[3]};
+    }
+
+    static int conv_out_size(int in, int kernel, int stride, int padding, int dilation)
+    {
+        return (in + 2 * padding - dilation * (kernel - 1) - 1) / stride + 1;
+    }
+
+    // Gemmini conv 제약 : 정사각 kernel, 축별 동일 parameter, kernel_dim > padding
+    static bool conv_params_supported(int KW, int KH, int s0, int s1, int p0, int p1, int d0, int d1)
+    {
+        return KW == KH && s0 == s1 && p0 == p1 && d0 == d1 &&
+               s0 >= 1 && d0 >= 1 && p0 >= 0 && KW > p0;
+    }
+
+    // NCHW (ggml) -> NHWC int8 : 양자화 pass 에서 layout 변환까지 함께 수행
+    static void pack_nhwc(const nchw_view &in, int N, int H, int W, int C, int8_t *dst, size_t stride)
+    {
+        for (int n = 0; n < N; n++)
+            for (int c = 0; c < C; c++)
+                for (int h = 0; h < H; h++) {
+                    int8_t *d = dst + (((size_t)n * H + h) * W) * stride + c;
+                    for (int w = 0; w < W; w++) {
+                        const char *p = in.at(n, c, h, w);
+                        const float v = in.type == GGML_TYPE_F16 ? ggml_fp16_to_fp32(*(const ggml_fp16_t *)p)
+                                                                  : *(const float *)p;
+                        d[w * stride] = static_cast<int8_t>(v);
+                    }
+                }
+    }
+
+    // NHWC int8 -> ggml FP32 출력 (역양자화 pass 에서 layout 복원)
+    static void unpack_nhwc(const int8_t *src, size_t stride, int N, int H, int W, int C, const nchw_view &out)
+    {
+        for (int n = 0; n < N; n++)
+            for (int h = 0; h < H; h++)
+                for (int w = 0; w < W; w++) {
+                    const int8_t *s = src + (((size_t)n * H + h) * W + w) * stride;
+                    for (int c = 0; c < C; c++)
+                        *(float *)out.at(n, c, h, w) = static_cast<float>(s[c]);
+                }
+    }
+
+    static ggml_gemmini_tensor<int8_t> stage_input_nhwc(ggml_context *ctx, const char *name,
+                                                        const nchw_view &in, const conv_shape &cs)
+    {
+        ggml_gemmini_tensor<int8_t> t(ctx, name, (size_t)cs.batch * cs.in_rows * cs.in_cols, cs.in_channels);
+        pack_nhwc(in, cs.batch, cs.in_rows, cs.in_cols, cs.in_channels, static_cast<int8_t *>(t.get()), t.get_stride());
+        return t;
+    }
+
+    static void store_output_nhwc(const ggml_gemmini_tensor<int8_t> &t, const nchw_view &out, const conv_shape &cs)
+    {
+        unpack_nhwc(static_cast<const int8_t *>(t.get()), t.get_stride(),
+                    cs.batch, cs.out_rows, cs.out_cols, cs.out_channels, out);
+    }
+
+    // ggml kernel [KW, KH, IC, OC] -> HWIO int8 ([KH][KW][IC] 행 x OC 열)
+    static ggml_gemmini_tensor<int8_t> pack_weight_hwio(ggml_context *ctx, const ggml_tensor *kernel)
+    {
+        const int KW = kernel->ne[0], KH = kernel->ne[1], IC = kernel->ne[2], OC = kernel->ne[3];
+
+        ggml_gemmini_tensor<int8_t> t(ctx, kernel->name, (size_t)KH * KW * IC, OC);
+        int8_t *dst = static_cast<int8_t *>(t.get());
+        const size_t stride = t.get_stride();
+
+        for (int oc = 0; oc < OC; oc++)
+            for (int ic = 0; ic < IC; ic++)
+                for (int kh = 0; kh < KH; kh++)
+                    for (int kw = 0; kw < KW; kw++)
+                        dst[(((size_t)kh * KW + kw) * IC + ic) * stride + oc] =
+                            static_cast<int8_t>(get_f32(kernel, kw, kh, ic, oc));
+        return t;
+    }
+
+    // ggml transposed conv kernel [KW, KH, OC, IC] -> HWIO int8 (회전은 wrot180 으로 Gemmini 가 처리)
+    static ggml_gemmini_tensor<int8_t> pack_weight_deconv_hwio(ggml_context *ctx, const ggml_tensor *kernel)
+    {
+        const int KW = kernel->ne[0], KH = kernel->ne[1], OC = kernel->ne[2], IC = kernel->ne[3];
+
+        ggml_gemmini_tensor<int8_t> t(ctx, kernel->name, (size_t)KH * KW * IC, OC);
+        int8_t *dst = static_cast<int8_t *>(t.get());
+        const size_t stride = t.get_stride();
+
+        for (int ic = 0; ic < IC; ic++)
+            for (int oc = 0; oc < OC; oc++)
+                for (int kh = 0; kh < KH; kh++)
+                    for (int kw = 0; kw < KW; kw++)
+                        dst[(((size_t)kh * KW + kw) * IC + ic) * stride + oc] =
+                            static_cast<int8_t>(get_f32(kernel, kw, kh, oc, ic));
+        return t;
+    }
+
+    // ggml depthwise kernel [KW, KH, 1, C] -> [C][KH][KW] int8 (행 stride 없이 연속 배치)
+    static ggml_gemmini_tensor<int8_t> pack_weight_dw(ggml_context *ctx, const ggml_tensor *kernel)
+    {
+        const int KW = kernel->ne[0], KH = kernel->ne[1], C = kernel->ne[3];
+
+        ggml_gemmini_tensor<int8_t> t(ctx, kernel->name, 1, (size_t)C * KH * KW);
+        int8_t *dst = static_cast<int8_t *>(t.get());
+
+        for (int c = 0; c < C; c++)
+            for (int kh = 0; kh < KH; kh++)
+                for (int kw = 0; kw < KW; kw++)
+                    dst[((size_t)c * KH + kh) * KW + kw] = static_cast<int8_t>(get_f32(kernel, kw, kh, 0, c));
+        return t;
+    }
+
+    // 공통 conv 실행 : in(NCHW) * kernel(OIHW) -> out(NCHW view)
+    static void run_conv(ggml_backend_gemmini_context *ctx, const conv_shape &cs,
+                         const ggml_tensor *kernel, const nchw_view &in, const nchw_view &out,
+                         const char *name)
+    {
+        DBG("conv: N=%d %dx%dx%d -> %dx%dx%d k=%d s=%d p=%d d=%d id=%d%s",
+            cs.batch, cs.in_rows, cs.in_cols, cs.in_channels,
+            cs.out_rows, cs.out_cols, cs.out_channels,
+            cs.kernel_dim, cs.stride, cs.padding, cs.dilation,
+            cs.input_dilation, cs.transposed ? " transposed" : "");
+
+        ggml_gemmini_tensor<int8_t> tI = stage_input_nhwc(ctx->tmp_ctx, name, in, cs);
+
+        std::optional<ggml_gemmini_tensor<int8_t>> local_w;
+        const ggml_gemmini_tensor<int8_t> &tW =
+            ctx->weight_cache->stage(ctx->tmp_ctx, kernel,
+                                     cs.transposed ? GEMMINI_LAYOUT_DECONV_HWIO : GEMMINI_LAYOUT_CONV_HWIO, local_w,
+                                     [&](ggml_context *c) {
+                                         return cs.transposed ? pack_weight_deconv_hwio(c, kernel) : pack_weight_hwio(c, kernel);
+                                     });
+
+        ggml_gemmini_tensor<int8_t> tO(ctx->tmp_ctx, name, (size_t)cs.batch * cs.out_rows * cs.out_cols, cs.out_channels);
+
+        // stride-2 1x1 (ResNet shortcut) : 출력 행마다 입력 화소를 2 칸 간격으로 읽는 matmul 하나
+        if (cs.kernel_dim == 1 && cs.stride == 2 && cs.padding == 0 && cs.input_dilation == 1 && !cs.transposed) {
+            std::unique_lock<std::mutex> own(ggml_gemmini_device_mutex(ctx->device));
+            tiled_conv_downsample(
+                cs.batch, cs.in_rows, cs.in_cols, cs.in_channels,
+                cs.out_channels, cs.out_rows, cs.out_cols,
+                tI.get_stride(), tW.get_stride(), tO.get_stride(),
+
+                (const elem_t *)tI.get(),
+                (const elem_t *)tW.get(),
+                NULL,
+                (elem_t *)tO.get(),
+
+                NO_ACTIVATION, ACC_SCALE_IDENTITY,
+
+                GGML_GEMMINI_TYPE);
+            own.unlock();
+
+            store_output_nhwc(tO, out, cs);
+            return;
+        }
+
+        std::unique_lock<std::mutex> own(ggml_gemmini_device_mutex(ctx->device));
+        tiled_conv_stride_auto(
+            cs.batch, cs.in_rows, cs.in_cols, cs.in_channels,
+            cs.out_channels, cs.out_rows, cs.out_cols,
+            cs.stride, cs.input_dilation, cs.dilation, cs.padding, cs.kernel_dim,
+            tI.get_stride(), tW.get_stride(), tO.get_stride(),
+            cs.transposed, false, false, false, false,
+
+            (const elem_t *)tI.get(),
+            (const elem_t *)tW.get(),
+            NULL,
+            (elem_t *)tO.get(),
+
+            NO_ACTIVATION, ACC_SCALE_IDENTITY,
+            1, 0, 0, // no pooling
+
+            GGML_GEMMINI_TYPE);
+        own.unlock();
+
+        store_output_nhwc(tO, out, cs);
+    }
+
+    // 1D conv : Gemmini conv 는 정사각 kernel 만 받으므로 K x 1 kernel 을 그대로 쓸 수 없다.
+    // 신호를 1 x OL 이미지로 보고 tap 을 채널 축으로 펼쳐 (열 k * IC + ic) 1x1 conv 로 실행.
+    // 펼치기는 어차피 필요한 int8 양자화 pass 안에서 수행. src_pos(o, k) 는 출력 o 의
+    // tap k 가 읽을 입력 위치 (없으면 -1)
+    template <typename P, typename W>
+    static void run_conv_1d(ggml_backend_gemmini_context *ctx,
+                            const ggml_tensor *kernel, ggml_gemmini_layout layout, W &&make_weight,
+                            const ggml_tensor *input, // [L, IC, N]
+                            const nchw_view &out,     // (n, oc, 0, o)
+                            int OL, int K, int IC, int OC, P &&src_pos, const char *name)
+    {
+        const int N = input->ne[2], L = input->ne[0];
+        DBG("conv_1d: N=%d L=%d IC=%d -> OL=%d OC=%d K=%d", N, L, IC, OL, OC, K);
+
+        std::optional<ggml_gemmini_tensor<int8_t>> local_w;
+        const ggml_gemmini_tensor<int8_t> &tW =
+            ctx->weight_cache->stage(ctx->tmp_ctx, kernel, layout, local_w, make_weight);
+
+        ggml_gemmini_tensor<int8_t> tI(ctx->tmp_ctx, name, (size_t)N * OL, (size_t)K * IC);
+        ggml_gemmini_tensor<int8_t> tO(ctx->tmp_ctx, name, (size_t)N * OL, OC);
+
+        int8_t *cols = static_cast<int8_t *>(tI.get());
+        const size_t sI = tI.get_stride();
+        parallel_for(ctx, (size_t)N * OL, 1, [&](size_t r0, size_t r1) {
+            for (size_t r = r0; r < r1; r++) {
+                const int n = r / OL, o = r % OL;
+                int8_t *row = cols + r * sI;
+                for (int k = 0; k < K; k++) {
+                    const int l = src_pos(o, k);
+                    if (l < 0 || l >= L)
+                        continue; // 0-fill 버퍼
+                    for (int ic = 0; ic < IC; ic++)
+                        row[k * IC + ic] = static_cast<int8_t>(get_f32(input, l, ic, n));
+                }
+            }
+        });
+
+        std::unique_lock<std::mutex> own(ggml_gemmini_device_mutex(ctx->device));
+        tiled_conv_stride_auto(
+            N, 1, OL, K * IC,
+            OC, 1, OL,
+            1, 1, 1, 0, 1,
+            sI, tW.get_stride(), tO.get_stride(),
+            false, false, false, false, false,
+
+            (const elem_t *)tI.get(),
+            (const elem_t *)tW.get(),
+            NULL,
+            (elem_t *)tO.get(),
+
+            NO_ACTIVATION, ACC_SCALE_IDENTITY,
+            1, 0, 0, // no pooling
+
+            GGML_GEMMINI_TYPE);
+        own.unlock();
+
+        unpack_nhwc(static_cast<const int8_t *>(tO.get()), tO.get_stride(), N, 1, OL, OC, out);
+    }
+}
+
+bool ggml_backend_gemmini_conv_2d_supported(const ggml_tensor *op)
+{
+    const ggml_tensor *kernel = op->src[0];
+    const ggml_tensor *input = op->src[1];
+
+    return op->type == GGML_TYPE_F32 &&
+           input->type == GGML_TYPE_F32 &&
+           (kernel->type == GGML_TYPE_F32 || kernel->type == GGML_TYPE_F16) &&
+           conv_params_supported(kernel->ne[0], kernel->ne[1],
+                                 ggml_get_op_params_i32(op, 0), ggml_get_op_params_i32(op, 1),
+                                 ggml_get_op_params_i32(op, 2), ggml_get_op_params_i32(op, 3),
+                                 ggml_get_op_params_i32(op, 4), ggml_get_op_params_i32(op, 5));
+}
+
+bool ggml_backend_gemmini_conv_2d_dw_supported(const ggml_tensor *op)
+{
+    const ggml_tensor *kernel = op->src[0];
+    const ggml_tensor *input = op->src[1];
+
+    // tiled_conv_dw 는 kernel dilation 을 지원하지 않는다
+    return op->type == GGML_TYPE_F32 &&
+           input->type == GGML_TYPE_F32 &&
+           (kernel->type == GGML_TYPE_F32 || kernel->type == GGML_TYPE_F16) &&
+           kernel->ne[2] == 1 && kernel->ne[3] == input->ne[2] &&
+           ggml_get_op_params_i32(op, 4) == 1 &&
+           conv_params_supported(kernel->ne[0], kernel->ne[1],
+                                 ggml_get_op_params_i32(op, 0), ggml_get_op_params_i32(op, 1),
+                                 ggml_get_op_params_i32(op, 2), ggml_get_op_params_i32(op, 3),
+                                 ggml_get_op_params_i32(op, 4), ggml_get_op_params_i32(op, 5));
+}
+
+ggml_tensor *ggml_backend_gemmini_match_im2col_mul_mat(const ggml_tensor *mm)
+{
+    if (mm->op != GGML_OP_MUL_MAT || mm->type != GGML_TYPE_F32)
+        return nullptr;
+
+    // ggml_conv_1d / ggml_conv_2d : mul_mat(reshape(im2col(kernel, input)), reshape(kernel))
+    ggml_tensor *t = mm->src[0];
+    while (t->op == GGML_OP_RESHAPE)
+        t = t->src[0];
+
+    if (t->op != GGML_OP_IM2COL)
+        return nullptr;
+
+    const ggml_tensor *kernel = t->src[0];
+    const ggml_tensor *input = t->src[1];
+    if (mm->src[1]->data != kernel->data || !ggml_is_contiguous(kernel) ||
+        input->type != GGML_TYPE_F32 ||
+        (kernel->type != GGML_TYPE_F32 && kernel->type != GGML_TYPE_F16))
+        return nullptr;
+
+    if (!ggml_get_op_params_i32(t, 6) /* is_2D */) {
+        // 1D : tap 을 채널로 펼쳐 1x1 conv 로 실행하므로 stride / padding / dilation 제약 없음
+        // 결과 shape 확인 : [N*OL, OC]
+        const int64_t OL = t->ne[1], N = t->ne[2];
+        if (mm->ne[0] != N * OL || mm->ne[1] != kernel->ne[2] || mm->ne[2] != 1 || mm->ne[3] != 1 ||
+            input->ne[3] != 1)
+            return nullptr;
+        return t;
+    }
+
+    if (!conv_params_supported(kernel->ne[0], kernel->ne[1],
+                               ggml_get_op_params_i32(t, 0), ggml_get_op_params_i32(t, 1),
+                               ggml_get_op_params_i32(t, 2), ggml_get_op_params_i32(t, 3),
+                               ggml_get_op_params_i32(t, 4), ggml_get_op_params_i32(t, 5)))
+        return nullptr;
+
+    // 결과 shape 확인 : [N*OH*OW, OC]
+    const int64_t OW = t->ne[1], OH = t->ne[2], N = t->ne[3];
+    if (mm->ne[0] != N * OH * OW || mm->ne[1] != kernel->ne[3] || mm->ne[2] != 1 || mm->ne[3] != 1)
+        return nullptr;
+
+    return t;
+}
+
+void ggml_backend_gemmini_conv_2d(ggml_backend_gemmini_context *ctx, ggml_tensor *dst)
+{
+    const ggml_tensor *kernel = dst->src[0]; // [KW, KH, IC, OC]
+    const ggml_tensor *input = dst->src[1];  // [W, H, IC, N]
+
+    conv_shape cs;
+    cs.batch = input->ne[3];
+    cs.in_rows = input->ne[1];
+    cs.in_cols = input->ne[0];
+    cs.in_channels = input->ne[2];
+    cs.out_channels = kernel->ne[3];
+    cs.out_rows = dst->ne[1];
+    cs.out_cols = dst->ne[0];
+    cs.stride = ggml_get_op_params_i32(dst, 0);
+    cs.padding = ggml_get_op_params_i32(dst, 2);
+    cs.dilation = ggml_get_op_params_i32(dst, 4);
+    cs.kernel_dim = kernel->ne[0];
+
+    run_conv(ctx, cs, kernel, view_whcn(input), view_whcn(dst), dst->name);
+}
+
+// ggml_conv_1d : kernel [K, IC, OC], input [L, IC, N], MUL_MAT 결과 layout [OC][N][OL]
+static void conv_1d_mul_mat(ggml_backend_gemmini_context *ctx, ggml_tensor *mm, const ggml_tensor *im2col)
+{
+    const ggml_tensor *kernel = im2col->src[0];
+    const ggml_tensor *input = im2col->src[1];
+
+    const int K = kernel->ne[0], IC = kernel->ne[1], OC = kernel->ne[2];
+    const int OL = im2col->ne[1];
+    const int s0 = ggml_get_op_params_i32(im2col, 0);
+    const int p0 = ggml_get_op_params_i32(im2col, 2);
+    const int d0 = ggml_get_op_params_i32(im2col, 4);
+
+    auto make_weight = [&](ggml_context *c) {
+        ggml_gemmini_tensor<int8_t> t(c, kernel->name, (size_t)K * IC, OC);
+        int8_t *w = static_cast<int8_t *>(t.get());
+        for (int k = 0; k < K; k++)
+            for (int ic = 0; ic < IC; ic++)
+                for (int oc = 0; oc < OC; oc++)
+                    w[((size_t)k * IC + ic) * t.get_stride() + oc] = static_cast<int8_t>(get_f32(kernel, k, ic, oc));
+        return t;
+    };
+
+    const size_t nb_w = mm->nb[0];
+    const nchw_view out = {(char *)mm->data, mm->type, nb_w, 0, mm->nb[1], nb_w * OL};
+
+    run_conv_1d(ctx, kernel, GEMMINI_LAYOUT_CONV_1D, make_weight, input, out, OL, K, IC, OC,
+                [&](int o, int k) { return o * s0 + k * d0 - p0; }, mm->name);
+}
+
+void ggml_backend_gemmini_conv_mul_mat(ggml_backend_gemmini_context *ctx, ggml_tensor *mm, const ggml_tensor *im2col)
+{
+    if (!ggml_get_op_params_i32(im2col, 6) /* is_2D */) {
+        conv_1d_mul_mat(ctx, mm, im2col);
+        return;
+    }
+
+    const ggml_tensor *kernel = im2col->src[0]; // [KW, KH, IC, OC]
+    const ggml_tensor *input = im2col->src[1];  // [W, H, IC, N]
+
+    conv_shape cs;
+    cs.batch = input->ne[3];
+    cs.in_rows = input->ne[1];
+    cs.in_cols = input->ne[0];
+    cs.in_channels = input->ne[2];
+    cs.out_channels = kernel->ne[3];
+    cs.out_rows = im2col->ne[2];
+    cs.out_cols = im2col->ne[1];
+    cs.stride = ggml_get_op_params_i32(im2col, 0);
+    cs.padding = ggml_get_op_params_i32(im2col, 2);
+    cs.dilation = ggml_get_op_params_i32(im2col, 4);
+    cs.kernel_dim = kernel->ne[0];
+
+    // MUL_MAT 결과 layout : [OC][N][OH][OW]
+    const size_t nb_w = mm->nb[0];
+    const nchw_view out = {(char *)mm->data, mm->type,
+                           nb_w, nb_w * cs.out_cols, mm->nb[1], nb_w * cs.out_cols * cs.out_rows};
+
+    run_conv(ctx, cs, kernel, view_whcn(input), out, mm->name);
+}
+
+void ggml_backend_gemmini_conv_2d_dw(ggml_backend_gemmini_context *ctx, ggml_tensor *dst)
+{
+    const ggml_tensor *kernel = dst->src[0]; // [KW, KH, 1, C]
+    const ggml_tensor *input = dst->src[1];  // [W, H, C, N]
+
+    const int N = input->ne[3], IH = input->ne[1], IW = input->ne[0], C = input->ne[2];
+    const int OH = dst->ne[1], OW = dst->ne[0];
+    const int K = kernel->ne[0];
+    const int stride = ggml_get_op_params_i32(dst, 0);
+    const int padding = ggml_get_op_params_i32(dst, 2);
+
+    DBG("conv_dw: N=%d %dx%dx%d -> %dx%d k=%d s=%d p=%d", N, IH, IW, C, OH, OW, K, stride, padding);
+
+    std::optional<ggml_gemmini_tensor<int8_t>> local_w;
+    const ggml_gemmini_tensor<int8_t> &tW =
+        ctx->weight_cache->stage(ctx->tmp_ctx, kernel, GEMMINI_LAYOUT_CONV_DW, local_w,
+                                 [&](ggml_context *c) { return pack_weight_dw(c, kernel); });
+
+    // tiled_conv_dw 는 채널 stride 를 따로 받지 않으므로 입출력은 C 간격으로 빈틈없이 배치
+    ggml_gemmini_tensor<int8_t> tI(ctx->tmp_ctx, dst->name, 1, (size_t)N * IH * IW * C);
+    ggml_gemmini_tensor<int8_t> tO(ctx->tmp_ctx, dst->name, 1, (size_t)N * OH * OW * C);
+    pack_nhwc(view_whcn(input), N, IH, IW, C, static_cast<int8_t *>(tI.get()), C);
+
+    std::unique_lock<std::mutex> own(ggml_gemmini_device_mutex(ctx->device));
+    tiled_conv_dw_auto(
+        N, IH, IW,
+        C, OH, OW,
+        stride, padding, K,
+
+        (elem_t *)tI.get(),
+        (elem_t *)tW.get(),
+        NULL,
+        (elem_t *)tO.get(),
+
+        NO_ACTIVATION, ACC_SCALE_IDENTITY,
+        1, 0, 0, // no pooling
+
+        GGML_GEMMINI_TYPE);
+    own.unlock();
+
+    unpack_nhwc(static_cast<const int8_t *>(tO.get()), C, N, OH, OW, C, view_whcn(dst));
+}
+
+bool ggml_backend_gemmini_conv_transpose_supported(const ggml_tensor *op)
+{
+    const ggml_tensor *kernel = op->src[0];
+    const ggml_tensor *input = op->src[1];
+
+    if (op->type != GGML_TYPE_F32 || input->type != GGML_TYPE_F32 ||
+        (kernel->type != GGML_TYPE_F32 && kernel->type != GGML_TYPE_F16))
+        return false;
+
+    if (op->op == GGML_OP_CONV_TRANSPOSE_1D) {
+        // op_params : s0, p0 (= 0), d0 (= 1)
+        return kernel->ne[2] == input->ne[1] &&
+               ggml_get_op_params_i32(op, 1) == 0 && ggml_get_op_params_i32(op, 2) == 1;
+    }
+
+    // 2D : stride 만큼 input dilation, padding K - 1 인 stride-1 conv (정사각 kernel)
+    // Gemmini 는 input dilation 2 까지만 지원 (CPU 모드 제외)
+    const int stride = ggml_get_op_params_i32(op, 0);
+    return kernel->ne[0] == kernel->ne[1] && kernel->ne[3] == input->ne[2] &&
+           stride >= 1 && (GGML_GEMMINI_TYPE == CPU || stride <= 2);
+}
+
+void ggml_backend_gemmini_conv_transpose_2d(ggml_backend_gemmini_context *ctx, ggml_tensor *dst)
+{
+    const ggml_tensor *kernel = dst->src[0]; // [KW, KH, OC, IC]
+    const ggml_tensor *input = dst->src[1];  // [W, H, IC, N]
+
+    conv_shape cs;
+    cs.batch = input->ne[3];
+    cs.in_rows = input->ne[1];
+    cs.in_cols = input->ne[0];
+    cs.in_channels = input->ne[2];
+    cs.out_channels = kernel->ne[2];
+    cs.out_rows = dst->ne[1];
+    cs.out_cols = dst->ne[0];
+    cs.kernel_dim = kernel->ne[0];
+    cs.input_dilation = ggml_get_op_params_i32(dst, 0);
+    cs.padding = cs.kernel_dim - 1;
+    cs.transposed = true;
+
+    run_conv(ctx, cs, kernel, view_whcn(input), view_whcn(dst), dst->name);
+}
+
+void ggml_backend_gemmini_conv_transpose_1d(ggml_backend_gemmini_context *ctx, ggml_tensor *dst)
+{
+    const ggml_tensor *kernel = dst->src[0]; // [K, OC, IC]
+    const ggml_tensor *input = dst->src[1];  // [L, IC, N]
+
+    const int K = kernel->ne[0], OC = kernel->ne[1], IC = kernel->ne[2];
+    const int s0 = ggml_get_op_params_i32(dst, 0);
+
+    // [k][ic] x oc : 출력 o 의 tap k 는 (o - k) / s0 위치의 입력 (나누어 떨어질 때만)
+    auto make_weight = [&](ggml_context *c) {
+        ggml_gemmini_tensor<int8_t> t(c, kernel->name, (size_t)K * IC, OC);
+        int8_t *w = static_cast<int8_t *>(t.get());
+        for (int k = 0; k < K; k++)
+            for (int ic = 0; ic < IC; ic++)
+                for (int oc = 0; oc < OC; oc++)
+                    w[((size_t)k * IC + ic) * t.get_stride() + oc] = static_cast<int8_t>(get_f32(kernel, k, oc, ic));
+        return t;
+    };
+
+    const nchw_view out = {(char *)dst->data, dst->type, dst->nb[0], 0, dst->nb[1], dst->nb[2]};
+    run_conv_1d(ctx, kernel, GEMMINI_LAYOUT_DECONV_1D, make_weight, input, out, dst->ne[0], K, IC, OC,
+                [&](int o, int k) { return o >= k && (o - k) % s0 == 0 ? (o - k) / s0 : -1; }, dst->name);
+}
+
+bool ggml_backend_gemmini_pool_2d_supported(const ggml_tensor *op)
+{
+    const ggml_tensor *input = op->src[0];
+    if (op->type != GGML_TYPE_F32 || input->type != GGML_TYPE_F32)
+        return false;
+
+    const int32_t *params = (const int32_t *)op->op_params;
+    const int pool = params[0], k0 = params[1], k1 = params[2], s0 = params[3], s1 = params[4];
+    const int p0 = params[5], p1 = params[6];
+
+    // Gemmini pooler 는 padding 을 0 으로 채우므로 (ggml 은 -inf) padding 없는 경우만
+    if (p0 != 0 || p1 != 0)
+        return false;
+
+    switch (pool) {
+    case GGML_OP_POOL_AVG:
+        // 입력 전체를 덮는 정사각 window = global average
+        return k0 == input->ne[0] && k1 == input->ne[1] && k0 == k1;
+    case GGML_OP_POOL_MAX:
+        // 1x1 identity depthwise conv 뒤의 pooler 로 처리
+        return k0 == k1 && s0 == s1 && s0 >= 1;
+    default:
+        return false;
+    }
+}
+
+// t 가 conv 출력 (NCHW feature map) 에서 element-wise / layout 연산만 거쳐 나온 텐서인지
+static bool is_feature_map(const ggml_tensor *t, int depth = 8)
+{
+    if (t == nullptr || depth == 0)
+        return false;
+
+    switch (t->op) {
+    case GGML_OP_CONV_2D:
+    case GGML_OP_CONV_2D_DW:
+    case GGML_OP_CONV_TRANSPOSE_2D:
+    case GGML_OP_POOL_2D:
+        return true;
+    case GGML_OP_MUL_MAT:
+        // ggml_conv_2d : IM2COL x kernel
+        return t->src[0]->op == GGML_OP_IM2COL || t->src[1]->op == GGML_OP_IM2COL;
+    case GGML_OP_ADD:
+    case GGML_OP_MUL:
+    case GGML_OP_SCALE:
+    case GGML_OP_CLAMP:
+    case GGML_OP_LEAKY_RELU:
+    case GGML_OP_UNARY:
+    case GGML_OP_GROUP_NORM:
+    case GGML_OP_CONT:
+    case GGML_OP_CPY:
+    case GGML_OP_RESHAPE:
+    case GGML_OP_VIEW:
+    case GGML_OP_PERMUTE:
+    case GGML_OP_TRANSPOSE:
+        for (int i = 0; i < GGML_MAX_SRC && t->src[i]; i++)
+            if (is_feature_map(t->src[i], depth - 1))
+                return true;
+        return false;
+    default:
+        return false;
+    }
+}
+
+bool ggml_backend_gemmini_mean_supported(const ggml_tensor *op)
+{
+    const ggml_tensor *input = op->src[0];
+    if (op->type != GGML_TYPE_F32 || input->type != GGML_TYPE_F32 || input->ne[3] != 1)
+        return false;
+
+    // global average pool 패턴만 : conv feature map [dim, dim, C, N] 을 [dim * dim, C, N] 으로 reshape 한 MEAN
+    if (input->op != GGML_OP_RESHAPE)
+        return false;
+    const ggml_tensor *fm = input->src[0];
+    return fm->ne[0] == fm->ne[1] && fm->ne[0] * fm->ne[1] == input->ne[0] &&
+           fm->ne[2] == input->ne[1] && fm->ne[3] == input->ne[2] &&
+           ggml_is_contiguous(fm) && is_feature_map(fm);
+}
+
+// [batches][count][channels] int8 (count = dim^2) 의 화소 평균 -> [batches][channels]
+static void global_average(ggml_backend_gemmini_context *ctx, const nchw_view &in, const nchw_view &out,
+                           int N, int H, int W, int C, int dim, const char *name)
+{
+    ggml_gemmini_tensor<int8_t> tI(ctx->tmp_ctx, name, 1, (size_t)N * H * W * C);
+    ggml_gemmini_tensor<int8_t> tO(ctx->tmp_ctx, name, 1, (size_t)N * C);
+
+    if (GGML_GEMMINI_TYPE == CPU) {
+        // CPU 모드 : 채널 block 단위로 thread pool 에 분배
+        //   block [c0, c1) 은 버퍼의 N * H * W * c0 위치에 [N][H * W][c1 - c0] 로 따로 pack
+        int8_t *bI = static_cast<int8_t *>(tI.get());
+        int8_t *bO = static_cast<int8_t *>(tO.get());
+        const size_t HW = (size_t)H * W;
+
+        parallel_for(ctx, C, DIM, [&](size_t c0, size_t c1) {
+            const int cb = c1 - c0;
+            nchw_view bin = in, bout = out;
+            bin.data += c0 * in.nb_c;
+            bout.data += c0 * out.nb_c;
+
+            pack_nhwc(bin, N, H, W, cb, bI + N * HW * c0, cb);
+            global_average_cpu((const elem_t *)(bI + N * HW * c0), (elem_t *)(bO + N * c0), N, cb, dim);
+            unpack_nhwc(bO + N * c0, cb, N, 1, 1, cb, bout);
+        });
+        return;
+    }
+
+    pack_nhwc(in, N, H, W, C, static_cast<int8_t *>(tI.get()), C);
+
+    std::unique_lock<std::mutex> own(ggml_gemmini_device_mutex(ctx->device));
+    tiled_global_average_auto((const elem_t *)tI.get(), (elem_t *)tO.get(), N, C, dim, GGML_GEMMINI_TYPE);
+    own.unlock();
+
+    unpack_nhwc(static_cast<const int8_t *>(tO.get()), C, N, 1, 1, C, out);
+}
+
+void ggml_backend_gemmini_pool_2d(ggml_backend_gemmini_context *ctx, ggml_tensor *dst)
+{
+    const ggml_tensor *input = dst->src[0]; // [W, H, C, N]
+
+    const int32_t *params = (const int32_t *)dst->op_params;
+    const int pool = params[0], k = params[1], stride = params[3];
+
+    const int N = input->ne[3], IH = input->ne[1], IW = input->ne[0], C = input->ne[2];
+    const int OH = dst->ne[1], OW = dst->ne[0];
+
+    DBG("pool_2d: %s N=%d %dx%dx%d k=%d s=%d", pool == GGML_OP_POOL_AVG ? "avg" : "max", N, IH, IW, C, k, stride);
+
+    if (pool == GGML_OP_POOL_AVG) {
+        global_average(ctx, view_whcn(input), view_whcn(dst), N, IH, IW, C, k, dst->name);
+        return;
+    }
+
+    // max : weight 1 인 1x1 depthwise conv 로 값을 그대로 통과시키고 conv pooler 에서 max
+    ggml_gemmini_tensor<int8_t> tW(ctx->tmp_ctx, dst->name, 1, C);
+    std::memset(tW.get(), 1, C);
+
+    ggml_gemmini_tensor<int8_t> tI(ctx->tmp_ctx, dst->name, 1, (size_t)N * IH * IW * C);
+    ggml_gemmini_tensor<int8_t> tO(ctx->tmp_ctx, dst->name, 1, (size_t)N * OH * OW * C);
+    pack_nhwc(view_whcn(input), N, IH, IW, C, static_cast<int8_t *>(tI.get()), C);
+
+    std::unique_lock<std::mutex> own(ggml_gemmini_device_mutex(ctx->device));
+    tiled_conv_dw_auto(
+        N, IH, IW,
+        C, IH, IW,
+        1, 0, 1,
+
+        (elem_t *)tI.get(),
+        (elem_t *)tW.get(),
+        NULL,
+        (elem_t *)tO.get(),
+
+        NO_ACTIVATION, ACC_SCALE_IDENTITY,
+        k, stride, 0,
+
+        GGML_GEMMINI_TYPE);
+    own.unlock();
+
+    unpack_nhwc(static_cast<const int8_t *>(tO.get()), C, N, OH, OW, C, view_whcn(dst));
+}
+
+void ggml_backend_gemmini_mean(ggml_backend_gemmini_context *ctx, ggml_tensor *dst)
+{
+    const ggml_tensor *input = dst->src[0]; // [count, C, N, 1] -> [1, C, N, 1]
+
+    const int count = input->ne[0], C = input->ne[1], N = input->ne[2];
+    const int dim = (int)std::lround(std::sqrt((double)count));
+
+    DBG("mean: N=%d count=%d C=%d", N, count, C);
+
+    // (n, c, h, w) -> 화소 = w(ne0), 채널 = c(ne1)
+    const nchw_view in = {(char *)input->data, input->type, input->nb[0], 0, input->nb[1], input->nb[2]};
+    const nchw_view out = {(char *)dst->data, dst->type, 0, 0, dst->nb[1], dst->nb[2]};
+
+    global_average(ctx, in, out, N, 1, count, C, dim, dst->name);
+}
+
+void ggml_backend_gemmini_im2col(ggml_backend_gemmini_context *ctx, ggml_tensor *dst)
+{
+    const ggml_tensor *kernel = dst->src[0];
+    const ggml_tensor *input = dst->src[1];
+
+    const int s0 = ggml_get_op_params_i32(dst, 0), s1 = ggml_get_op_params_i32(dst, 1);
+    const int p0 = ggml_get_op_params_i32(dst, 2), p1 = ggml_get_op_params_i32(dst, 3);
+    const int d0 = ggml_get_op_params_i32(dst, 4), d1 = ggml_get_op_params_i32(dst, 5);
+    const bool is_2D = ggml_get_op_params_i32(dst, 6) == 1;
+
+    // 1D 는 H = KH = OH = 1 인 2D 로 취급
+    const int64_t N  = is_2D ? input->ne[3] : input->ne[2];
+    const int64_t IC = is_2D ? input->ne[2] : input->ne[1];
+    const int64_t IH = is_2D ? input->ne[1] : 1;
+    const int64_t IW = input->ne[0];
+    const int64_t KH = is_2D ? kernel->ne[1] : 1;
+    const int64_t KW = kernel->ne[0];
+    const int64_t OH = is_2D ? dst->ne[2] : 1;
+    const int64_t OW = dst->ne[1];
+
+    const size_t in_nb_c = is_2D ? input->nb[2] : input->nb[1];
+    const size_t in_nb_n = is_2D ? input->nb[3] : input->nb[2];
+
+    parallel_for(ctx, (size_t)(N * OH), 1, [&](size_t r0, size_t r1) {
+        for (size_t r = r0; r < r1; r++) {
+            const int64_t n = r / OH, oh = r % OH;
+            for (int64_t ow = 0; ow < OW; ow++) {
+                char *drow = (char *)dst->data + (is_2D ? n * dst->nb[3] + oh * dst->nb[2] : n * dst->nb[2]) + ow * dst->nb[1];
+                for (int64_t ic = 0; ic < IC; ic++)
+                    for (int64_t kh = 0; kh < KH; kh++)
+                        for (int64_t kw = 0; kw < KW; kw++) {
+                            const int64_t iw = ow * s0 + kw * d0 - p0;
+                            const int64_t ih = is_2D ? oh * s1 + kh * d1 - p1 : 0;
+
+                            float v = 0.0f;
+                            if (iw >= 0 && iw < IW && ih >= 0 && ih < IH)
+                                v = *(const float *)((const char *)input->data + n * in_nb_n + ic * in_nb_c + ih * input->nb[1] * is_2D + iw * input->nb[0]);
+
+                            const int64_t i0 = (ic * KH + kh) * KW + kw;
+                            if (dst->type == GGML_TYPE_F16)
+                                ((ggml_fp16_t *)drow)[i0] = ggml_fp32_to_fp16(v);
+                            else
+                                ((float *)drow)[i0] = v;
+                        }
+            }
+        }
+    });
+}
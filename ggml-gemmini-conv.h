@@ -0,0 +1,51 @@
+// ggml-gemmini-conv.h
+#ifndef __GGML_GEMMINI_CONV_H__
+#define __GGML_GEMMINI_CONV_H__
+
+#include "ggml.h"
+#include "ggml-gemmini-util.h"
+
+// CONV_2D : Gemmini conv engine (tiled_conv_stride_auto) 로 처리 가능한지
+bool ggml_backend_gemmini_conv_2d_supported(const ggml_tensor *op);
+
+// CONV_2D_DW : tiled_conv_dw 로 처리 가능한지 (dilation 없음, channel multiplier 1)
+bool ggml_backend_gemmini_conv_2d_dw_supported(const ggml_tensor *op);
+
+// IM2COL -> (RESHAPE) -> MUL_MAT 패턴이면 IM2COL 노드를, 아니면 nullptr 반환
+ggml_tensor *ggml_backend_gemmini_match_im2col_mul_mat(const ggml_tensor *mm);
+
+// GGML_OP_CONV_2D
+void ggml_backend_gemmini_conv_2d(ggml_backend_gemmini_context *ctx, ggml_tensor *dst);
+
+// GGML_OP_CONV_2D_DW (ggml_conv_2d_dw_direct)
+void ggml_backend_gemmini_conv_2d_dw(ggml_backend_gemmini_context *ctx, ggml_tensor *dst);
+
+// IM2COL + MUL_MAT 패턴 (ggml_conv_1d / ggml_conv_2d) 을 native conv 로 실행
+// (결과는 MUL_MAT 노드 layout 으로 기록)
+void ggml_backend_gemmini_conv_mul_mat(ggml_backend_gemmini_context *ctx, ggml_tensor *mm, const ggml_tensor *im2col);
+
+// CONV_TRANSPOSE_1D / CONV_TRANSPOSE_2D 를 conv engine 으로 처리 가능한지
+bool ggml_backend_gemmini_conv_transpose_supported(const ggml_tensor *op);
+
+// GGML_OP_CONV_TRANSPOSE_2D : input dilation + wrot180 conv
+void ggml_backend_gemmini_conv_transpose_2d(ggml_backend_gemmini_context *ctx, ggml_tensor *dst);
+
+// GGML_OP_CONV_TRANSPOSE_1D
+void ggml_backend_gemmini_conv_transpose_1d(ggml_backend_gemmini_context *ctx, ggml_tensor *dst);
+
+// POOL_2D : global average (avg) 또는 conv pooler (max, padding 없음) 로 처리 가능한지
+bool ggml_backend_gemmini_pool_2d_supported(const ggml_tensor *op);
+
+// MEAN : ne0 (dim x dim 화소) 에 대한 평균을 global average 로 처리 가능한지
+bool ggml_backend_gemmini_mean_supported(const ggml_tensor *op);
+
+// GGML_OP_POOL_2D
+void ggml_backend_gemmini_pool_2d(ggml_backend_gemmini_context *ctx, ggml_tensor *dst);
+
+// GGML_OP_MEAN (채널별 공간 평균)
+void ggml_backend_gemmini_mean(ggml_backend_gemmini_context *ctx, ggml_tensor *dst);
+
+// 패턴에 포함되지 않은 IM2COL 의 host fallback
+void ggml_backend_gemmini_im2col(ggml_backend_gemmini_context *ctx, ggml_tensor *dst);
+
+#endif // __GGML_GEMMINI_CONV_H__
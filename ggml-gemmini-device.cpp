@@ -0,0 +1,278 @@
+// ggml-gemmini-device.cpp
+#include "ggml-gemmini-device.h"
+#include "ggml-gemmini-util.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+using namespace zerogod;
+
+namespace
+{
+#ifdef __linux__
+    // process 원래 affinity : device 목록을 만들 때 (어떤 thread 도 hart 에 고정되기 전) 저장
+    cpu_set_t host_set;
+    bool host_set_valid = false;
+#endif
+}
+
+const std::vector<ggml_gemmini_device_info> &zerogod::ggml_gemmini_devices()
+{
+    static const std::vector<ggml_gemmini_device_info> devices = [] {
+#ifdef __linux__
+        host_set_valid = pthread_getaffinity_np(pthread_self(), sizeof(host_set), &host_set) == 0;
+#endif
+
+        std::vector<int> harts;
+        if (const char *env = std::getenv("GGML_GEMMINI_HARTS")) {
+            for (const char *p = env; *p;) {
+                char *end;
+                const long h = std::strtol(p, &end, 10);
+                if (end == p)
+                    break;
+                harts.push_back((int)h);
+                p = *end == ',' ? end + 1 : end;
+            }
+        }
+        if (harts.empty()) {
+            for (int i = 0; i < GGML_GEMMINI_N_DEVICES; i++)
+                harts.push_back(GGML_GEMMINI_N_DEVICES > 1 ? i : -1);
+        }
+
+        std::vector<ggml_gemmini_device_info> v;
+        for (size_t i = 0; i < harts.size(); i++) {
+            char name[32], desc[64];
+            if (harts.size() == 1)
+                snprintf(name, sizeof(name), "GEMMINI");
+            else
+                snprintf(name, sizeof(name), "GEMMINI%zu", i);
+            if (harts[i] >= 0)
+                snprintf(desc, sizeof(desc), "GEMMINI (hart %d)", harts[i]);
+            else
+                snprintf(desc, sizeof(desc), "GEMMINI");
+            v.push_back({(int)i, harts[i], name, desc});
+        }
+        return v;
+    }();
+    return devices;
+}
+
+// ______________________hart affinity______________________
+ggml_gemmini_hart_scope::ggml_gemmini_hart_scope(int hart)
+{
+#ifdef __linux__
+    if (hart < 0)
+        return;
+
+    cpu_set_t old_set, set;
+    if (pthread_getaffinity_np(pthread_self(), sizeof(old_set), &old_set) != 0)
+        return;
+
+    CPU_ZERO(&set);
+    CPU_SET(hart, &set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+        GGML_LOG_WARN("%s: failed to pin thread to hart %d\n", __func__, hart);
+        return;
+    }
+
+    saved_.resize(sizeof(old_set));
+    std::memcpy(saved_.data(), &old_set, sizeof(old_set));
+    pinned_ = true;
+#else
+    GGML_UNUSED(hart);
+#endif
+}
+
+ggml_gemmini_hart_scope::~ggml_gemmini_hart_scope()
+{
+#ifdef __linux__
+    if (pinned_) {
+        cpu_set_t old_set;
+        std::memcpy(&old_set, saved_.data(), sizeof(old_set));
+        pthread_setaffinity_np(pthread_self(), sizeof(old_set), &old_set);
+    }
+#endif
+}
+
+void zerogod::ggml_gemmini_unpin_thread()
+{
+#ifdef __linux__
+    thread_local bool done = false;
+    if (done)
+        return;
+    done = true;
+
+    // hart 고정이 없으면 (device 하나, GGML_GEMMINI_HARTS 없음) 풀 것도 없음
+    const auto &devices = ggml_gemmini_devices();
+    const bool pinned = std::any_of(devices.begin(), devices.end(),
+                                    [](const ggml_gemmini_device_info &d) { return d.hart >= 0; });
+    if (pinned && host_set_valid)
+        pthread_setaffinity_np(pthread_self(), sizeof(host_set), &host_set);
+#endif
+}
+
+// ______________________device ownership______________________
+std::mutex &zerogod::ggml_gemmini_device_mutex(int device)
+{
+    static std::vector<std::mutex> mutexes(ggml_gemmini_devices().size());
+    return mutexes.at(device);
+}
+
+ggml_gemmini_device_claim::ggml_gemmini_device_claim(int first, int n)
+{
+    const int n_dev = (int)ggml_gemmini_devices().size();
+    for (int i = 1; i < n; i++) {
+        const int d = (first + i) % n_dev;
+        if (!ggml_gemmini_device_mutex(d).try_lock()) {
+            for (int h : held_)
+                ggml_gemmini_device_mutex(h).unlock();
+            held_.clear();
+            return;
+        }
+        held_.push_back(d);
+    }
+    ok_ = true;
+}
+
+ggml_gemmini_device_claim::~ggml_gemmini_device_claim()
+{
+    for (int d : held_)
+        ggml_gemmini_device_mutex(d).unlock();
+}
+
+// ______________________device worker pool______________________
+ggml_gemmini_device_pool &ggml_gemmini_device_pool::instance()
+{
+    static ggml_gemmini_device_pool pool;
+    return pool;
+}
+
+ggml_gemmini_device_pool::ggml_gemmini_device_pool()
+{
+    // worker 0 은 쓰지 않지만 (jobs[0] 은 호출 thread) index 를 device 와 맞추기 위해 모두 생성
+    for (const ggml_gemmini_device_info &d : ggml_gemmini_devices()) {
+        workers_.push_back(std::make_unique<worker>());
+        worker &w = *workers_.back();
+        w.thread = std::thread([this, &w, hart = d.hart] { loop(w, hart); });
+    }
+}
+
+ggml_gemmini_device_pool::~ggml_gemmini_device_pool()
+{
+    for (auto &w : workers_) {
+        {
+            std::lock_guard<std::mutex> lk(w->mtx);
+            w->stop = true;
+        }
+        w->cv.notify_one();
+        w->thread.join();
+    }
+}
+
+void ggml_gemmini_device_pool::loop(worker &w, int hart)
+{
+    ggml_gemmini_hart_scope pin(hart);
+
+    for (;;) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lk(w.mtx);
+            w.cv.wait(lk, [&] { return w.stop || !w.queue.empty(); });
+            if (w.queue.empty())
+                return;
+            job = std::move(w.queue.front());
+            w.queue.pop_front();
+        }
+        job();
+    }
+}
+
+void ggml_gemmini_device_pool::run(int first, const std::vector<std::function<void()>> &jobs)
+{
+    const size_t n = workers_.size();
+    GGML_ASSERT(jobs.size() <= n);
+
+    std::vector<std::future<void>> done;
+    for (size_t i = 1; i < jobs.size(); i++) {
+        auto task = std::make_shared<std::packaged_task<void()>>(jobs[i]);
+        done.push_back(task->get_future());
+
+        worker &w = *workers_[(first + i) % n];
+        {
+            std::lock_guard<std::mutex> lk(w.mtx);
+            w.queue.push_back([task] { (*task)(); });
+        }
+        w.cv.notify_one();
+    }
+
+    if (!jobs.empty())
+        jobs[0]();
+    for (auto &f : done)
+        f.get();
+}
+
+// ______________________backend command queue______________________
+ggml_gemmini_queue::ggml_gemmini_queue(int hart)
+    : thread_([this, hart] { loop(hart); })
+{
+}
+
+ggml_gemmini_queue::~ggml_gemmini_queue()
+{
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        stop_ = true;
+    }
+    cv_.notify_one();
+    thread_.join();
+}
+
+void ggml_gemmini_queue::submit(std::function<void()> cmd)
+{
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        queue_.push_back(std::move(cmd));
+    }
+    cv_.notify_one();
+}
+
+void ggml_gemmini_queue::synchronize()
+{
+    if (std::this_thread::get_id() == thread_.get_id())
+        return;
+
+    std::unique_lock<std::mutex> lk(mtx_);
+    idle_cv_.wait(lk, [&] { return queue_.empty() && !busy_; });
+}
+
+void ggml_gemmini_queue::loop(int hart)
+{
+    ggml_gemmini_hart_scope pin(hart);
+
+    std::unique_lock<std::mutex> lk(mtx_);
+    for (;;) {
+        cv_.wait(lk, [&] { return stop_ || !queue_.empty(); });
+        if (queue_.empty())
+            return;
+
+        std::function<void()> cmd = std::move(queue_.front());
+        queue_.pop_front();
+        busy_ = true;
+
+        lk.unlock();
+        cmd();
+        lk.lock();
+
+        busy_ = false;
+        if (queue_.empty())
+            idle_cv_.notify_all();
+    }
+}
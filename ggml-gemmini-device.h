@@ -0,0 +1,133 @@
+// ggml-gemmini-device.h
+#ifndef __GGML_GEMMINI_DEVICE_H__
+#define __GGML_GEMMINI_DEVICE_H__
+
+#include "ggml.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// GGML_GEMMINI_HARTS 환경 변수가 없을 때의 device 수
+#ifndef GGML_GEMMINI_N_DEVICES
+#define GGML_GEMMINI_N_DEVICES 1
+#endif
+
+namespace zerogod
+{
+    // SoC 의 Gemmini 가 붙은 hart 하나 = ggml device 하나
+    struct ggml_gemmini_device_info
+    {
+        int index;
+        int hart; // Gemmini 명령을 보낼 hart (-1 : affinity 를 건드리지 않음)
+        std::string name;
+        std::string description;
+    };
+
+    // device 목록 : GGML_GEMMINI_HARTS="0,2,4" 처럼 hart 를 나열하면 그 수만큼,
+    // 없으면 GGML_GEMMINI_N_DEVICES 개 (여러 개면 hart = index, 하나면 affinity 고정 없음)
+    const std::vector<ggml_gemmini_device_info> &ggml_gemmini_devices();
+
+    // 호출 thread 를 hart 에 고정하고 scope 를 벗어나면 원래 affinity 로 복원
+    class ggml_gemmini_hart_scope
+    {
+    public:
+        explicit ggml_gemmini_hart_scope(int hart);
+        ~ggml_gemmini_hart_scope();
+
+        ggml_gemmini_hart_scope(const ggml_gemmini_hart_scope &) = delete;
+        ggml_gemmini_hart_scope &operator=(const ggml_gemmini_hart_scope &) = delete;
+
+    private:
+        bool pinned_ = false;
+        std::vector<unsigned char> saved_; // 이전 cpu_set_t
+    };
+
+    // device 의 Gemmini 사용권 : 한 Gemmini 에 두 명령 흐름이 섞이면 양쪽 결과가 모두 깨지므로
+    //   Gemmini 호출 하나 (matmul / conv / resadd) 동안 자기 device 를, 다른 device 로 조각을 보내는 쪽은 그 device 도 잡음
+    std::mutex &ggml_gemmini_device_mutex(int device);
+
+    // first 다음 device n - 1 개의 사용권을 기다리지 않고 얻음 (first 는 호출측이 이미 잡고 있음)
+    //   하나라도 사용 중 (다른 backend 의 Gemmini 호출 중) 이면 아무것도 잡지 않고 실패
+    class ggml_gemmini_device_claim
+    {
+    public:
+        ggml_gemmini_device_claim(int first, int n);
+        ~ggml_gemmini_device_claim();
+
+        ggml_gemmini_device_claim(const ggml_gemmini_device_claim &) = delete;
+        ggml_gemmini_device_claim &operator=(const ggml_gemmini_device_claim &) = delete;
+
+        explicit operator bool() const { return ok_; }
+
+    private:
+        std::vector<int> held_;
+        bool ok_ = false;
+    };
+
+    // device 마다 그 hart 에 고정된 worker thread : 다른 device 의 Gemmini 로 작업 (tensor parallel 조각) 을 보냄
+    class ggml_gemmini_device_pool
+    {
+    public:
+        static ggml_gemmini_device_pool &instance();
+        ~ggml_gemmini_device_pool();
+
+        size_t size() const { return workers_.size(); }
+
+        // jobs[i] 를 device (first + i) % size() 에서 실행하고 모두 끝날 때까지 대기
+        //   jobs[0] 은 호출 thread (device first 의 hart 에서 실행 중) 가 직접 실행
+        //   호출측은 ggml_gemmini_device_claim(first, jobs.size()) 를 잡고 있어야 함
+        void run(int first, const std::vector<std::function<void()>> &jobs);
+
+    private:
+        ggml_gemmini_device_pool();
+
+        struct worker
+        {
+            std::thread thread;
+            std::mutex mtx;
+            std::condition_variable cv;
+            std::deque<std::function<void()>> queue;
+            bool stop = false;
+        };
+
+        void loop(worker &w, int hart);
+
+        std::vector<std::unique_ptr<worker>> workers_;
+    };
+
+    // backend 하나의 명령 queue : hart 에 고정된 worker thread 가 들어온 순서대로 실행
+    //   async upload / download 와 graph 실행을 받아 호출측은 바로 반환
+    class ggml_gemmini_queue
+    {
+    public:
+        explicit ggml_gemmini_queue(int hart);
+        ~ggml_gemmini_queue(); // 남은 명령을 모두 실행한 뒤 종료
+
+        ggml_gemmini_queue(const ggml_gemmini_queue &) = delete;
+        ggml_gemmini_queue &operator=(const ggml_gemmini_queue &) = delete;
+
+        void submit(std::function<void()> cmd);
+
+        // 지금까지 submit 된 명령이 모두 끝날 때까지 대기 (worker thread 에서 부르면 바로 반환)
+        void synchronize();
+
+    private:
+        void loop(int hart);
+
+        std::mutex mtx_;
+        std::condition_variable cv_;      // 새 명령 / 종료
+        std::condition_variable idle_cv_; // 명령 완료
+        std::deque<std::function<void()>> queue_;
+        bool busy_ = false;
+        bool stop_ = false;
+        std::thread thread_;
+    };
+}
+
+#endif // __GGML_GEMMINI_DEVICE_H__
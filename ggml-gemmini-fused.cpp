@@ -0,0 +1,923 @@
+// ggml-gemmini-fused.cpp
+#include "ggml-gemmini-fused.h"
+#include "ggml-gemmini-tensor.h"
+#include "ggml-gemmini-device.h"
+#include "gemmini.h"
+
+#include <optional>
+#include <cmath>
+#include <vector>
+
+// LM head 를 한 번에 처리할 vocab 열 수 (int8 C chunk : n_tokens x chunk)
+#ifndef GGML_GEMMINI_LM_HEAD_CHUNK
+#define GGML_GEMMINI_LM_HEAD_CHUNK 4096
+#endif
+
+// epilogue 에서 유지할 top-k 의 최대 k (이보다 크면 ARGSORT 를 그대로 실행)
+#ifndef GGML_GEMMINI_TOP_K_MAX
+#define GGML_GEMMINI_TOP_K_MAX 64
+#endif
+
+using namespace zerogod;
+
+namespace
+{
+    inline float silu_f32(float x)
+    {
+        return x / (1.0f + expf(-x));
+    }
+
+    // 행 (i1, i2, i3) 의 시작 주소. 작은 텐서는 ggml_can_repeat 규칙으로 broadcast
+    inline char *row_ptr(const ggml_tensor *t, int64_t i1, int64_t i2, int64_t i3)
+    {
+        return (char *)t->data + (i1 % t->ne[1]) * t->nb[1]
+                               + (i2 % t->ne[2]) * t->nb[2]
+                               + (i3 % t->ne[3]) * t->nb[3];
+    }
+
+    inline float at_f32(const char *row, const ggml_tensor *t, int64_t i0)
+    {
+        return *(const float *)(row + i0 * t->nb[0]);
+    }
+
+    bool single_use(const ggml_tensor *t, const std::map<const ggml_tensor *, int> &n_uses)
+    {
+        auto it = n_uses.find(t);
+        return !(t->flags & GGML_TENSOR_FLAG_OUTPUT) && it != n_uses.end() && it->second == 1;
+    }
+
+    // gate / up 이 같은 activation 을 쓰는 같은 shape 의 2D projection 인지
+    bool ffn_pair(const ggml_tensor *gate, const ggml_tensor *up)
+    {
+        if (gate == nullptr || up == nullptr || gate == up ||
+            gate->op != GGML_OP_MUL_MAT || up->op != GGML_OP_MUL_MAT)
+            return false;
+
+        const ggml_tensor *wg = gate->src[0], *wu = up->src[0], *x = gate->src[1];
+        return x == up->src[1] &&
+               x->type == GGML_TYPE_F32 && ggml_is_matrix(x) &&
+               ggml_is_matrix(wg) && ggml_are_same_shape(wg, wu) &&
+               ggml_is_contiguous(x) && ggml_is_contiguous(wg) && ggml_is_contiguous(wu) &&
+               (wg->type == GGML_TYPE_F32 || wg->type == GGML_TYPE_F16) &&
+               (wu->type == GGML_TYPE_F32 || wu->type == GGML_TYPE_F16);
+    }
+
+    // ROPE op_params (ggml_rope_ext) 중 normal / NEOX 모드에 필요한 값
+    struct rope_params
+    {
+        int n_dims = 0;
+        bool neox = false;
+        float freq_scale = 1.0f, ext_factor = 0.0f, attn_factor = 1.0f;
+        float theta_scale = 1.0f;
+        float corr_dims[2] = {0.0f, 0.0f};
+        const float *freq_factors = nullptr;
+    };
+
+    rope_params get_rope_params(const ggml_tensor *rope)
+    {
+        rope_params rp;
+        rp.n_dims = ggml_get_op_params_i32(rope, 1);
+        rp.neox = (ggml_get_op_params_i32(rope, 2) & GGML_ROPE_TYPE_NEOX) != 0;
+
+        const int n_ctx_orig = ggml_get_op_params_i32(rope, 4);
+        const float freq_base = ggml_get_op_params_f32(rope, 5);
+        rp.freq_scale = ggml_get_op_params_f32(rope, 6);
+        rp.ext_factor = ggml_get_op_params_f32(rope, 7);
+        rp.attn_factor = ggml_get_op_params_f32(rope, 8);
+        const float beta_fast = ggml_get_op_params_f32(rope, 9);
+        const float beta_slow = ggml_get_op_params_f32(rope, 10);
+
+        rp.theta_scale = powf(freq_base, -2.0f / rp.n_dims);
+        ggml_rope_yarn_corr_dims(rp.n_dims, n_ctx_orig, freq_base, beta_fast, beta_slow, rp.corr_dims);
+        rp.freq_factors = rope->src[2] ? (const float *)rope->src[2]->data : nullptr;
+        return rp;
+    }
+
+    // 위치 p 의 (cos, sin) 을 cache[i0], cache[i0 + 1] 에 기록 (YaRN 포함, ggml-cpu 와 동일한 식)
+    void rope_cache(const rope_params &rp, float p, float *cache)
+    {
+        float theta = p;
+        for (int i0 = 0; i0 < rp.n_dims; i0 += 2) {
+            const float theta_extrap = rp.freq_factors ? theta / rp.freq_factors[i0 / 2] : theta;
+            float theta_i = rp.freq_scale * theta_extrap;
+            float mscale = rp.attn_factor;
+            if (rp.ext_factor != 0.0f) {
+                const float y = (i0 / 2 - rp.corr_dims[0]) / std::max(0.001f, rp.corr_dims[1] - rp.corr_dims[0]);
+                const float ramp_mix = (1.0f - std::min(1.0f, std::max(0.0f, y))) * rp.ext_factor;
+                theta_i = theta_i * (1.0f - ramp_mix) + theta_extrap * ramp_mix;
+                mscale *= 1.0f + 0.1f * logf(1.0f / rp.freq_scale);
+            }
+            cache[i0] = cosf(theta_i) * mscale;
+            cache[i0 + 1] = sinf(theta_i) * mscale;
+            theta *= rp.theta_scale;
+        }
+    }
+
+    // head 하나 (ne0 원소, byte stride snb0 / dnb0) 회전. src == dst 면 in-place
+    void rope_row(const rope_params &rp, const float *cache,
+                  const char *src, size_t snb0, char *dst, size_t dnb0, int64_t ne0)
+    {
+        const int64_t half = rp.n_dims / 2;
+        for (int64_t i0 = 0; i0 < rp.n_dims; i0 += 2) {
+            const int64_t a = rp.neox ? i0 / 2 : i0;
+            const int64_t b = rp.neox ? i0 / 2 + half : i0 + 1;
+            const float x0 = *(const float *)(src + a * snb0);
+            const float x1 = *(const float *)(src + b * snb0);
+            *(float *)(dst + a * dnb0) = x0 * cache[i0] - x1 * cache[i0 + 1];
+            *(float *)(dst + b * dnb0) = x0 * cache[i0 + 1] + x1 * cache[i0];
+        }
+        if (src != dst)
+            for (int64_t i0 = rp.n_dims; i0 < ne0; i0++)
+                *(float *)(dst + i0 * dnb0) = *(const float *)(src + i0 * snb0);
+    }
+
+    // int8 결과 한 행 -> out 의 행 n. rope 가 있으면 행이 cache 에 있을 때 head 별로 바로 회전
+    void store_row(const int8_t *c, ggml_tensor *out, int64_t n,
+                   const ggml_tensor *rope, const rope_params &rp, std::vector<float> &cache)
+    {
+        char *drow = (char *)out->data + n * out->nb[1];
+        for (int64_t m = 0; m < out->ne[0]; m++)
+            *(float *)(drow + m * out->nb[0]) = (float)c[m];
+
+        if (!rope)
+            return;
+
+        const int64_t D = rope->ne[0], H = rope->ne[1];
+        cache.resize(rp.n_dims);
+        rope_cache(rp, (float)((const int32_t *)rope->src[1]->data)[n], cache.data());
+        for (int64_t h = 0; h < H; h++)
+            rope_row(rp, cache.data(), drow + h * D * sizeof(float), sizeof(float),
+                     drow + h * D * sizeof(float), sizeof(float), D);
+    }
+
+    // 같은 K 의 ggml weight [K, M_i] 들 -> K x sum(M_i) int8 panel (열 [off_i, off_i + M_i) = weight i)
+    ggml_gemmini_tensor<int8_t> pack_weight_concat(ggml_context *ctx, const std::vector<const ggml_tensor *> &ws)
+    {
+        const int64_t K = ws[0]->ne[0];
+        int64_t J = 0;
+        for (const ggml_tensor *w : ws)
+            J += w->ne[1];
+
+        ggml_gemmini_tensor<int8_t> t(ctx, ws[0]->name, K, J);
+        int8_t *dst = static_cast<int8_t *>(t.get());
+        const size_t stride = t.get_stride();
+
+        int64_t off = 0;
+        for (const ggml_tensor *w : ws) {
+            for (int64_t m = 0; m < w->ne[1]; m++)
+                for (int64_t k = 0; k < K; k++)
+                    dst[k * stride + off + m] = static_cast<int8_t>(get_f32(w, k, m));
+            off += w->ne[1];
+        }
+        return t;
+    }
+
+    // ggml weight [K, M] 의 열 [j0, j0 + n) -> K x n int8 panel
+    ggml_gemmini_tensor<int8_t> pack_weight_cols(ggml_context *ctx, const ggml_tensor *w, int64_t j0, int64_t n)
+    {
+        const int64_t K = w->ne[0];
+
+        ggml_gemmini_tensor<int8_t> t(ctx, w->name, K, n);
+        int8_t *dst = static_cast<int8_t *>(t.get());
+        const size_t stride = t.get_stride();
+
+        for (int64_t m = 0; m < n; m++)
+            for (int64_t k = 0; k < K; k++)
+                dst[k * stride + m] = static_cast<int8_t>(get_f32(w, k, j0 + m));
+        return t;
+    }
+
+    // 내림차순 top-k (vals / idx 길이 k, 현재 cnt 개). 같은 값이면 먼저 들어온 index 가 앞
+    inline void top_k_push(float *vals, int32_t *idx, int &cnt, int k, float v, int32_t j)
+    {
+        if (cnt == k && v <= vals[k - 1])
+            return;
+        int p = cnt < k ? cnt++ : k - 1;
+        for (; p > 0 && vals[p - 1] < v; p--) {
+            vals[p] = vals[p - 1];
+            idx[p] = idx[p - 1];
+        }
+        vals[p] = v;
+        idx[p] = j;
+    }
+
+    // 묶어서 실행할 수 있는 MUL_MAT : 2D F32 activation, 2D F32 / F16 weight, bias 는 1 행 (repeating) 만
+    bool group_candidate(const ggml_backend_gemmini_context *ctx, const ggml_tensor *mm)
+    {
+        if (mm->op != GGML_OP_MUL_MAT || ctx->fused_nodes.count((ggml_tensor *)mm) || ctx->conv_map.count((ggml_tensor *)mm) ||
+            ctx->lm_head_map.count((ggml_tensor *)mm))
+            return false;
+
+        const ggml_tensor *w = mm->src[0], *x = mm->src[1];
+        if (x->type != GGML_TYPE_F32 || !ggml_is_matrix(x) || !ggml_is_matrix(w) ||
+            !ggml_is_contiguous(x) || !ggml_is_contiguous(w) ||
+            (w->type != GGML_TYPE_F32 && w->type != GGML_TYPE_F16))
+            return false;
+
+        auto it = ctx->bias_map.find((ggml_tensor *)mm);
+        return it == ctx->bias_map.end() || it->second->ne[1] == 1;
+    }
+}
+
+bool ggml_backend_gemmini_match_ffn(const ggml_tensor *node,
+                                    const std::map<const ggml_tensor *, int> &n_uses,
+                                    ggml_gemmini_ffn_match &m)
+{
+    m = {};
+    if (node->type != GGML_TYPE_F32)
+        return false;
+
+    if (node->op == GGML_OP_GLU) {
+        // split 형태 (ggml_swiglu_split) 만 : src0 = gate, src1 = up
+        if (ggml_get_glu_op(node) != GGML_GLU_OP_SWIGLU || node->src[1] == nullptr)
+            return false;
+        m.gate = node->src[0];
+        m.up = node->src[1];
+    } else if (node->op == GGML_OP_MUL) {
+        for (int s = 0; s < 2; s++) {
+            ggml_tensor *a = node->src[s];
+            if (a->op == GGML_OP_UNARY && ggml_get_unary_op(a) == GGML_UNARY_OP_SILU &&
+                a->type == GGML_TYPE_F32 && single_use(a, n_uses)) {
+                m.silu = a;
+                m.gate = a->src[0];
+                m.up = node->src[1 - s];
+                break;
+            }
+        }
+    }
+
+    if (!ffn_pair(m.gate, m.up) ||
+        !single_use(m.gate, n_uses) || !single_use(m.up, n_uses) ||
+        !ggml_are_same_shape(m.gate, node) || !ggml_are_same_shape(m.up, node)) {
+        m = {};
+        return false;
+    }
+    return true;
+}
+
+void ggml_backend_gemmini_ffn(ggml_backend_gemmini_context *ctx, ggml_tensor *dst, const ggml_gemmini_ffn_match &m)
+{
+    DBG("[Gemmini] ffn gate/up call: %s\n", dst->name);
+
+    const ggml_tensor *wg = m.gate->src[0];
+    const ggml_tensor *wu = m.up->src[0];
+    const ggml_tensor *x = m.gate->src[1];
+
+    const size_t I = x->ne[1];  // N
+    const size_t M = wg->ne[1]; // gate / up 각각의 출력 폭
+    const size_t J = 2 * M;
+    const size_t K = wg->ne[0];
+
+    // gate | up panel : 두 weight 모두 weight buffer 에 있을 때만 cache (key 는 gate, up 쌍)
+    auto make = [&](ggml_context *c) { return pack_weight_concat(c, {wg, wu}); };
+    std::optional<ggml_gemmini_tensor<int8_t>> local;
+    const ggml_gemmini_tensor<int8_t> *tB;
+    if (ggml_gemmini_weight_cache::cacheable(wg) && ggml_gemmini_weight_cache::cacheable(wu))
+        tB = &ctx->weight_cache->get({wg, wu}, GEMMINI_LAYOUT_FFN_GATE_UP, make);
+    else
+        tB = &local.emplace(make(ctx->tmp_ctx));
+
+    std::optional<ggml_gemmini_tensor<int8_t>> localA;
+    const auto &tA = ctx->staging->get(ctx->tmp_ctx, x, GEMMINI_STAGE_ROWS, localA, [&](ggml_context *c) {
+        return ggml_gemmini_tensor<int8_t>(c, x, ".i8");
+    });
+    ggml_gemmini_tensor<int8_t> tC(ctx->tmp_ctx, dst->name, I, J);
+
+    std::unique_lock<std::mutex> own(ggml_gemmini_device_mutex(ctx->device));
+    tiled_matmul_auto(I, J, K,
+                      (const elem_t *)tA.get(),
+                      (const elem_t *)tB->get(),
+                      NULL,
+                      (elem_t *)tC.get(),
+                      tA.get_stride(), tB->get_stride(), 0, tC.get_stride(),
+                      MVIN_SCALE_IDENTITY, MVIN_SCALE_IDENTITY, MVIN_SCALE_IDENTITY,
+                      NO_ACTIVATION,
+                      ACC_SCALE_IDENTITY, 0,
+                      false,
+                      false, false,
+                      false, false,
+                      0, GGML_GEMMINI_TYPE);
+    own.unlock();
+
+    // epilogue : int8 gate / up (unfused MUL_MAT 의 결과와 동일) -> silu(gate) * up
+    const int8_t *C = static_cast<const int8_t *>(tC.get());
+    const size_t sC = tC.get_stride();
+
+    parallel_for(ctx, I, 1, [&](size_t n0, size_t n1) {
+        for (size_t n = n0; n < n1; n++) {
+            const int8_t *g = C + n * sC;
+            const int8_t *u = g + M;
+            char *drow = (char *)dst->data + n * dst->nb[1];
+            for (size_t i = 0; i < M; i++)
+                *(float *)(drow + i * dst->nb[0]) = silu_f32((float)g[i]) * (float)u[i];
+        }
+    });
+}
+
+void ggml_backend_gemmini_plan_mul_mat_groups(ggml_backend_gemmini_context *ctx, ggml_cgraph *cgraph)
+{
+    // 텐서 (view 는 원본 기준) 를 처음 실제로 읽는 노드 index
+    std::map<const ggml_tensor *, int> first_use;
+    std::map<const ggml_tensor *, std::vector<std::pair<int, ggml_tensor *>>> by_src1;
+    for (int i = 0; i < cgraph->n_nodes; i++) {
+        ggml_tensor *node = cgraph->nodes[i];
+        if (is_view_op(node))
+            continue;
+        for (int s = 0; s < GGML_MAX_SRC && node->src[s]; s++)
+            first_use.emplace(view_root(node->src[s]), i);
+        if (group_candidate(ctx, node))
+            by_src1[node->src[1]].push_back({i, node});
+    }
+
+    // 묶음은 마지막 MUL_MAT 위치에서 실행되므로, 앞선 MUL_MAT 의 결과 (또는 fusion 된 ADD) 가
+    // 그 전에 읽히면 안 됨
+    auto deferrable = [&](ggml_tensor *mm, int idx) {
+        auto it = first_use.find(mm);
+        if (it != first_use.end() && it->second < idx)
+            return false;
+        auto jt = ctx->fused_out.find(mm);
+        if (jt != ctx->fused_out.end()) {
+            auto kt = first_use.find(jt->second);
+            if (kt != first_use.end() && kt->second < idx)
+                return false;
+        }
+        return true;
+    };
+
+    // (from, to) 사이에 src1 을 in-place 로 덮어쓰는 노드가 있는지
+    auto clobbered = [&](const ggml_tensor *src1, int from, int to) {
+        const ggml_tensor *root = view_root(src1);
+        for (int j = from + 1; j < to; j++) {
+            const ggml_tensor *n = cgraph->nodes[j];
+            if (!is_view_op(n) && n->view_src && view_root(n) == root)
+                return true;
+        }
+        return false;
+    };
+
+    auto flush = [&](std::vector<ggml_tensor *> &g) {
+        if (g.size() >= 2) {
+            for (size_t k = 0; k + 1 < g.size(); k++)
+                ctx->fused_nodes.insert(g[k]);
+            ctx->mm_groups[g.back()] = g;
+        }
+        g.clear();
+    };
+
+    for (auto &[src1, mms] : by_src1) {
+        std::vector<ggml_tensor *> g;
+        int first = -1;
+        for (auto &[idx, mm] : mms) {
+            bool ok = !g.empty() && !clobbered(src1, first, idx);
+            for (ggml_tensor *p : g)
+                ok = ok && deferrable(p, idx);
+            if (!ok) {
+                flush(g);
+                first = idx;
+            }
+            g.push_back(mm);
+        }
+        flush(g);
+    }
+}
+
+void ggml_backend_gemmini_mul_mat_group(ggml_backend_gemmini_context *ctx, const std::vector<ggml_tensor *> &mms)
+{
+    DBG("[Gemmini] mul_mat group call: %zu x %s\n", mms.size(), mms[0]->src[1]->name);
+
+    const ggml_tensor *x = mms[0]->src[1];
+    const size_t I = x->ne[1]; // N
+    const size_t K = x->ne[0];
+
+    std::vector<const ggml_tensor *> ws;
+    std::vector<size_t> off(1, 0);
+    bool cacheable = true, has_bias = false;
+    for (ggml_tensor *mm : mms) {
+        ws.push_back(mm->src[0]);
+        off.push_back(off.back() + mm->src[0]->ne[1]);
+        cacheable = cacheable && ggml_gemmini_weight_cache::cacheable(mm->src[0]);
+        has_bias = has_bias || ctx->bias_map.count(mm);
+    }
+    const size_t J = off.back();
+
+    // 이어 붙인 weight panel (key 는 묶음의 weight 목록 전체)
+    auto make = [&](ggml_context *c) { return pack_weight_concat(c, ws); };
+    std::optional<ggml_gemmini_tensor<int8_t>> local;
+    const ggml_gemmini_tensor<int8_t> *tB = cacheable ? &ctx->weight_cache->get(ws, GEMMINI_LAYOUT_MUL_MAT_CONCAT, make)
+                                                      : &local.emplace(make(ctx->tmp_ctx));
+
+    // bias 는 묶음 전체 폭의 repeating D 한 행으로 (bias 가 없는 MUL_MAT 구간은 0)
+    std::optional<ggml_gemmini_tensor<int32_t>> tD;
+    if (has_bias) {
+        tD.emplace(ctx->tmp_ctx, "mm_group.bias", 1, J);
+        int32_t *D = static_cast<int32_t *>(tD->get());
+        for (size_t k = 0; k < mms.size(); k++) {
+            auto it = ctx->bias_map.find(mms[k]);
+            if (it == ctx->bias_map.end())
+                continue;
+            for (size_t m = 0; m < off[k + 1] - off[k]; m++)
+                D[off[k] + m] = static_cast<int32_t>(get_f32(it->second, m));
+        }
+    }
+
+    std::optional<ggml_gemmini_tensor<int8_t>> localA;
+    const auto &tA = ctx->staging->get(ctx->tmp_ctx, x, GEMMINI_STAGE_ROWS, localA, [&](ggml_context *c) {
+        return ggml_gemmini_tensor<int8_t>(c, x, ".i8");
+    });
+    ggml_gemmini_tensor<int8_t> tC(ctx->tmp_ctx, mms.back()->name, I, J);
+
+    std::unique_lock<std::mutex> own(ggml_gemmini_device_mutex(ctx->device));
+    tiled_matmul_auto(I, J, K,
+                      (const elem_t *)tA.get(),
+                      (const elem_t *)tB->get(),
+                      tD ? tD->get() : NULL,
+                      (elem_t *)tC.get(),
+                      tA.get_stride(), tB->get_stride(), tD ? tD->get_stride() : 0, tC.get_stride(),
+                      MVIN_SCALE_IDENTITY, MVIN_SCALE_IDENTITY, MVIN_SCALE_IDENTITY,
+                      NO_ACTIVATION,
+                      ACC_SCALE_IDENTITY, 0,
+                      tD.has_value(),
+                      false, false,
+                      false, false,
+                      0, GGML_GEMMINI_TYPE);
+    own.unlock();
+
+    // C 의 열 구간을 각 MUL_MAT (또는 fusion 된 ADD) 로 분배, Q / K 는 RoPE 까지 적용
+    std::vector<ggml_tensor *> outs;
+    std::vector<const ggml_tensor *> ropes;
+    std::vector<rope_params> rps;
+    for (ggml_tensor *mm : mms) {
+        auto jt = ctx->fused_out.find(mm);
+        outs.push_back(jt != ctx->fused_out.end() ? jt->second : mm);
+        auto rt = ctx->rope_map.find(mm);
+        ropes.push_back(rt != ctx->rope_map.end() ? rt->second : nullptr);
+        rps.push_back(ropes.back() ? get_rope_params(ropes.back()) : rope_params{});
+    }
+
+    const int8_t *C = static_cast<const int8_t *>(tC.get());
+    const size_t sC = tC.get_stride();
+
+    parallel_for(ctx, I, 1, [&](size_t n0, size_t n1) {
+        std::vector<float> cache;
+        for (size_t n = n0; n < n1; n++)
+            for (size_t k = 0; k < outs.size(); k++)
+                store_row(C + n * sC + off[k], outs[k], n, ropes[k], rps[k], cache);
+    });
+}
+
+void ggml_backend_gemmini_store_rows(ggml_backend_gemmini_context *ctx, const int8_t *C, size_t sC,
+                                     ggml_tensor *out, const ggml_tensor *rope)
+{
+    const rope_params rp = rope ? get_rope_params(rope) : rope_params{};
+
+    parallel_for(ctx, out->ne[1], 1, [&](size_t n0, size_t n1) {
+        std::vector<float> cache;
+        for (size_t n = n0; n < n1; n++)
+            store_row(C + n * sC, out, n, rope, rp, cache);
+    });
+}
+
+bool ggml_backend_gemmini_rope_supported(const ggml_tensor *op)
+{
+    const ggml_tensor *src0 = op->src[0];
+    const ggml_tensor *pos = op->src[1];
+    const ggml_tensor *ff = op->src[2];
+
+    const int n_dims = ggml_get_op_params_i32(op, 1);
+    const int mode = ggml_get_op_params_i32(op, 2);
+
+    // normal / NEOX 만 (multimodal / vision rope 는 CPU 로)
+    return op->type == GGML_TYPE_F32 && src0->type == GGML_TYPE_F32 &&
+           (mode & ~GGML_ROPE_TYPE_NEOX) == 0 &&
+           n_dims % 2 == 0 && n_dims <= op->ne[0] &&
+           pos->type == GGML_TYPE_I32 && pos->ne[0] == src0->ne[2] && ggml_is_contiguous(pos) &&
+           (ff == nullptr || (ff->type == GGML_TYPE_F32 && ggml_is_contiguous(ff) && ff->ne[0] >= n_dims / 2));
+}
+
+ggml_tensor *ggml_backend_gemmini_match_rope(const ggml_backend_gemmini_context *ctx,
+                                             const ggml_tensor *rope,
+                                             const std::map<const ggml_tensor *, int> &n_uses,
+                                             const std::map<const ggml_tensor *, int> &node_idx)
+{
+    if (!ggml_backend_gemmini_rope_supported(rope) || !ggml_is_contiguous(rope) ||
+        !ggml_is_contiguous(rope->src[0]) || rope->ne[3] != 1)
+        return nullptr;
+
+    // ROPE <- RESHAPE* <- MUL_MAT (또는 MUL_MAT 에 fusion 된 bias ADD), 중간 결과는 이 경로에서만 사용
+    const ggml_tensor *t = rope->src[0];
+    for (; t->op == GGML_OP_RESHAPE; t = t->src[0])
+        if (!single_use(t, n_uses))
+            return nullptr;
+    if (!single_use(t, n_uses))
+        return nullptr;
+
+    ggml_tensor *mm = nullptr;
+    if (t->op == GGML_OP_MUL_MAT)
+        mm = (ggml_tensor *)t;
+    else if (t->op == GGML_OP_ADD)
+        for (auto &[m, out] : ctx->fused_out)
+            if (out == t)
+                mm = m;
+
+    if (!mm || ctx->conv_map.count(mm) || ctx->fused_nodes.count(mm) ||
+        !ggml_is_contiguous(mm->src[0]) || !ggml_is_contiguous(mm->src[1]) ||
+        !ggml_is_matrix(t) || t->ne[0] != rope->ne[0] * rope->ne[1] || t->ne[1] != rope->ne[2] ||
+        t->nb[0] != sizeof(float))
+        return nullptr;
+
+    // 위치 / freq factor 는 MUL_MAT 실행 전에 준비되어 있어야 함
+    const int mm_idx = node_idx.at(mm);
+    for (int s = 1; s < 3; s++)
+        for (const ggml_tensor *p = rope->src[s]; p != nullptr; p = p->view_src) {
+            auto it = node_idx.find(p);
+            if (it != node_idx.end() && it->second > mm_idx)
+                return nullptr;
+        }
+    return mm;
+}
+
+void ggml_backend_gemmini_rope(ggml_backend_gemmini_context *ctx, ggml_tensor *dst)
+{
+    const ggml_tensor *src0 = dst->src[0];
+    const rope_params rp = get_rope_params(dst);
+    const int32_t *pos = (const int32_t *)dst->src[1]->data;
+
+    const int64_t ne1 = dst->ne[1], ne2 = dst->ne[2];
+    parallel_for(ctx, (size_t)(ne2 * dst->ne[3]), 1, [&](size_t r0, size_t r1) {
+        std::vector<float> cache(rp.n_dims);
+        for (size_t r = r0; r < r1; r++) {
+            const int64_t i2 = r % ne2, i3 = r / ne2;
+            rope_cache(rp, (float)pos[i2], cache.data());
+            for (int64_t i1 = 0; i1 < ne1; i1++)
+                rope_row(rp, cache.data(),
+                         (const char *)src0->data + i1 * src0->nb[1] + i2 * src0->nb[2] + i3 * src0->nb[3], src0->nb[0],
+                         (char *)dst->data + i1 * dst->nb[1] + i2 * dst->nb[2] + i3 * dst->nb[3], dst->nb[0],
+                         dst->ne[0]);
+        }
+    });
+}
+
+bool ggml_backend_gemmini_match_lm_head(const ggml_cgraph *cgraph,
+                                        const ggml_tensor *node,
+                                        const std::map<const ggml_tensor *, int> &n_uses,
+                                        const std::map<const ggml_tensor *, int> &node_idx,
+                                        ggml_tensor *&mm,
+                                        ggml_gemmini_lm_head &h)
+{
+    h = {};
+    mm = nullptr;
+
+    if (node->op == GGML_OP_ARGMAX) {
+        h.sel = (ggml_tensor *)node;
+        h.k = 1;
+    } else if (node->op == GGML_OP_VIEW && node->src[0]->op == GGML_OP_ARGSORT) {
+        // ggml_top_k : VIEW(ARGSORT(a, DESC)) 의 앞 k 열
+        ggml_tensor *as = node->src[0];
+        if (ggml_get_op_params_i32(as, 0) != GGML_SORT_ORDER_DESC || node->view_offs != 0 ||
+            node->ne[0] > GGML_GEMMINI_TOP_K_MAX || node->nb[1] != as->nb[1] || !single_use(as, n_uses))
+            return false;
+        h.sel = as;
+        h.k = (int)node->ne[0];
+    } else {
+        return false;
+    }
+
+    ggml_tensor *a = h.sel->src[0];
+    if (a->op != GGML_OP_MUL_MAT || !ggml_is_matrix(a) || a->type != GGML_TYPE_F32 ||
+        h.sel->type != GGML_TYPE_I32 || !ggml_is_contiguous(h.sel) ||
+        a->src[1]->type != GGML_TYPE_F32 || !ggml_is_matrix(a->src[1]) ||
+        !ggml_is_matrix(a->src[0]) || !ggml_is_contiguous(a->src[0]) || !ggml_is_contiguous(a->src[1]) ||
+        (a->src[0]->type != GGML_TYPE_F32 && a->src[0]->type != GGML_TYPE_F16) ||
+        h.k > a->ne[0])
+        return false;
+
+    // 선택 결과는 MUL_MAT 위치에서 기록하므로 그 사이에 다른 연산이 없어야 함 (view 제외)
+    const int i_mm = node_idx.at(a), i_sel = node_idx.at(h.sel);
+    if (i_sel <= i_mm)
+        return false;
+    for (int j = i_mm + 1; j < i_sel; j++)
+        if (!is_view_op(cgraph->nodes[j]))
+            return false;
+
+    // logits 를 다른 노드도 쓰거나 graph 출력이면 chunk 마다 같이 기록
+    h.logits = (a->flags & GGML_TENSOR_FLAG_OUTPUT) || n_uses.at(a) > 1;
+    mm = a;
+    return true;
+}
+
+void ggml_backend_gemmini_lm_head(ggml_backend_gemmini_context *ctx, ggml_tensor *mm, const ggml_gemmini_lm_head &h)
+{
+    DBG("[Gemmini] lm head call: %s, k=%d logits=%d\n", mm->name, h.k, h.logits);
+
+    const ggml_tensor *w = mm->src[0]; // [K, n_vocab]
+    const ggml_tensor *x = mm->src[1]; // [K, N]
+
+    const size_t I = x->ne[1];
+    const size_t V = w->ne[1];
+    const size_t K = w->ne[0];
+    const size_t chunk = std::min<size_t>(V, GGML_GEMMINI_LM_HEAD_CHUNK);
+    const int k = h.k;
+
+    std::optional<ggml_gemmini_tensor<int8_t>> localA;
+    const auto &tA = ctx->staging->get(ctx->tmp_ctx, x, GEMMINI_STAGE_ROWS, localA, [&](ggml_context *c) {
+        return ggml_gemmini_tensor<int8_t>(c, x, ".i8");
+    });
+
+    // weight buffer 의 output weight 는 K x n_vocab panel 하나로 cache 하고 chunk 는 열 offset 으로 접근
+    const ggml_gemmini_tensor<int8_t> *tW = nullptr;
+    if (ggml_gemmini_weight_cache::cacheable(w))
+        tW = &ctx->weight_cache->get(w, GEMMINI_LAYOUT_LM_HEAD, [&](ggml_context *c) {
+            return pack_weight_cols(c, w, 0, V);
+        });
+
+    ggml_gemmini_tensor<int8_t> tC(ctx->tmp_ctx, mm->name, I, chunk);
+    const int8_t *C = static_cast<const int8_t *>(tC.get());
+    const size_t sC = tC.get_stride();
+
+    std::vector<float> vals(I * k);
+    std::vector<int32_t> idx(I * k);
+    std::vector<int> cnt(I, 0);
+
+    for (size_t j0 = 0; j0 < V; j0 += chunk) {
+        const size_t J = std::min(chunk, V - j0);
+
+        std::optional<ggml_gemmini_tensor<int8_t>> localB;
+        const elem_t *B;
+        size_t sB;
+        if (tW) {
+            B = (const elem_t *)tW->get() + j0;
+            sB = tW->get_stride();
+        } else {
+            localB.emplace(pack_weight_cols(ctx->tmp_ctx, w, j0, J));
+            B = (const elem_t *)localB->get();
+            sB = localB->get_stride();
+        }
+
+        std::unique_lock<std::mutex> own(ggml_gemmini_device_mutex(ctx->device));
+        tiled_matmul_auto(I, J, K,
+                          (const elem_t *)tA.get(), B, NULL, (elem_t *)tC.get(),
+                          tA.get_stride(), sB, 0, sC,
+                          MVIN_SCALE_IDENTITY, MVIN_SCALE_IDENTITY, MVIN_SCALE_IDENTITY,
+                          NO_ACTIVATION,
+                          ACC_SCALE_IDENTITY, 0,
+                          false,
+                          false, false,
+                          false, false,
+                          0, GGML_GEMMINI_TYPE);
+        own.unlock();
+
+        // epilogue : 행마다 running top-k 갱신 (+ 요청 시 logits chunk 기록)
+        parallel_for(ctx, I, 1, [&](size_t n0, size_t n1) {
+            for (size_t n = n0; n < n1; n++) {
+                const int8_t *c = C + n * sC;
+                if (h.logits) {
+                    char *drow = (char *)mm->data + n * mm->nb[1] + j0 * mm->nb[0];
+                    for (size_t j = 0; j < J; j++)
+                        *(float *)(drow + j * mm->nb[0]) = (float)c[j];
+                }
+                for (size_t j = 0; j < J; j++)
+                    top_k_push(&vals[n * k], &idx[n * k], cnt[n], k, (float)c[j], (int32_t)(j0 + j));
+            }
+        });
+    }
+
+    // ARGMAX : [N] , ARGSORT : 각 행의 앞 k 개 (VIEW 가 읽는 부분)만
+    for (size_t n = 0; n < I; n++) {
+        int32_t *dst = (int32_t *)((char *)h.sel->data + (h.sel->op == GGML_OP_ARGMAX ? n * h.sel->nb[0] : n * h.sel->nb[1]));
+        for (int i = 0; i < k; i++)
+            dst[i] = idx[n * k + i];
+    }
+}
+
+bool ggml_backend_gemmini_mul_mat_id_supported(const ggml_tensor *op)
+{
+    const ggml_tensor *as = op->src[0];
+    const ggml_tensor *b = op->src[1];
+    const ggml_tensor *ids = op->src[2];
+
+    return op->type == GGML_TYPE_F32 && b->type == GGML_TYPE_F32 && ids->type == GGML_TYPE_I32 &&
+           (as->type == GGML_TYPE_F32 || as->type == GGML_TYPE_F16) &&
+           as->ne[3] == 1 && b->ne[3] == 1 && op->ne[3] == 1;
+}
+
+void ggml_backend_gemmini_mul_mat_id(ggml_backend_gemmini_context *ctx, ggml_tensor *dst)
+{
+    DBG("[Gemmini] mul_mat_id call: %s\n", dst->name);
+
+    // dst[:, e, t] = as[:, :, ids[e, t]]^T * b[:, e % ne11, t]
+    const ggml_tensor *as = dst->src[0]; // [K, M, n_expert]
+    const ggml_tensor *b = dst->src[1];  // [K, ne11, n_tokens]
+    const ggml_tensor *ids = dst->src[2]; // [n_expert_used, n_tokens]
+
+    const int64_t K = as->ne[0], M = as->ne[1], n_expert = as->ne[2];
+    const int64_t n_used = ids->ne[0], n_tokens = ids->ne[1];
+
+    // 1. routing : (slot, token) 행을 expert 별로 모은 순서 (counting sort)
+    std::vector<int64_t> count(n_expert + 1, 0);
+    auto expert_of = [&](int64_t e, int64_t t) {
+        const int32_t x = *(const int32_t *)((const char *)ids->data + e * ids->nb[0] + t * ids->nb[1]);
+        GGML_ASSERT(x >= 0 && x < n_expert);
+        return x;
+    };
+    for (int64_t t = 0; t < n_tokens; t++)
+        for (int64_t e = 0; e < n_used; e++)
+            count[expert_of(e, t) + 1]++;
+    for (int64_t x = 0; x < n_expert; x++)
+        count[x + 1] += count[x];
+
+    const size_t rows = (size_t)count[n_expert];
+    std::vector<int64_t> order(rows); // 정렬된 행 -> e * n_tokens + t
+    {
+        std::vector<int64_t> fill(count.begin(), count.end() - 1);
+        for (int64_t t = 0; t < n_tokens; t++)
+            for (int64_t e = 0; e < n_used; e++)
+                order[fill[expert_of(e, t)]++] = e * n_tokens + t;
+    }
+
+    // 2. gather : 정렬된 순서로 activation 행을 연속된 int8 staging 버퍼에
+    ggml_gemmini_tensor<int8_t> tA(ctx->tmp_ctx, b->name, rows, K);
+    ggml_gemmini_tensor<int8_t> tC(ctx->tmp_ctx, dst->name, rows, M);
+    int8_t *A = static_cast<int8_t *>(tA.get());
+    const size_t sA = tA.get_stride(), sC = tC.get_stride();
+
+    parallel_for(ctx, rows, 1, [&](size_t r0, size_t r1) {
+        for (size_t r = r0; r < r1; r++) {
+            const int64_t e = order[r] / n_tokens, t = order[r] % n_tokens;
+            const char *src = (const char *)b->data + (e % b->ne[1]) * b->nb[1] + t * b->nb[2];
+            for (int64_t k = 0; k < K; k++)
+                A[r * sA + k] = static_cast<int8_t>(*(const float *)(src + k * b->nb[0]));
+        }
+    });
+
+    // 3. active expert 마다 matmul 한 번 (expert weight 는 cache)
+    const bool cacheable = ggml_gemmini_weight_cache::cacheable(as);
+    for (int64_t x = 0; x < n_expert; x++) {
+        const size_t r0 = count[x], I = count[x + 1] - count[x];
+        if (I == 0)
+            continue;
+
+        auto make = [&](ggml_context *c) {
+            ggml_gemmini_tensor<int8_t> t(c, as->name, K, M);
+            int8_t *w = static_cast<int8_t *>(t.get());
+            const size_t stride = t.get_stride();
+            for (int64_t m = 0; m < M; m++)
+                for (int64_t k = 0; k < K; k++)
+                    w[k * stride + m] = static_cast<int8_t>(get_f32(as, k, m, x));
+            return t;
+        };
+        std::optional<ggml_gemmini_tensor<int8_t>> local;
+        const ggml_gemmini_tensor<int8_t> &tB = cacheable
+            ? ctx->weight_cache->get(as, GEMMINI_LAYOUT_MOE_EXPERT, x, make)
+            : local.emplace(make(ctx->tmp_ctx));
+
+        std::lock_guard<std::mutex> own(ggml_gemmini_device_mutex(ctx->device));
+        tiled_matmul_auto(I, M, K,
+                          (const elem_t *)A + r0 * sA,
+                          (const elem_t *)tB.get(),
+                          NULL,
+                          (elem_t *)tC.get() + r0 * sC,
+                          sA, tB.get_stride(), 0, sC,
+                          MVIN_SCALE_IDENTITY, MVIN_SCALE_IDENTITY, MVIN_SCALE_IDENTITY,
+                          NO_ACTIVATION,
+                          ACC_SCALE_IDENTITY, 0,
+                          false,
+                          false, false,
+                          false, false,
+                          0, GGML_GEMMINI_TYPE);
+    }
+
+    // 4. scatter : 결과 행을 원래 (slot, token) 위치로
+    const int8_t *C = static_cast<const int8_t *>(tC.get());
+    parallel_for(ctx, rows, 1, [&](size_t r0, size_t r1) {
+        for (size_t r = r0; r < r1; r++) {
+            const int64_t e = order[r] / n_tokens, t = order[r] % n_tokens;
+            char *drow = (char *)dst->data + e * dst->nb[1] + t * dst->nb[2];
+            for (int64_t m = 0; m < M; m++)
+                *(float *)(drow + m * dst->nb[0]) = (float)C[r * sC + m];
+        }
+    });
+}
+
+bool ggml_backend_gemmini_select_supported(const ggml_tensor *op)
+{
+    const ggml_tensor *src0 = op->src[0];
+    return op->type == GGML_TYPE_I32 && src0->type == GGML_TYPE_F32 && ggml_is_contiguous(op) &&
+           (op->op == GGML_OP_ARGMAX ? ggml_is_matrix(src0) : ggml_are_same_shape(src0, op));
+}
+
+void ggml_backend_gemmini_select(ggml_backend_gemmini_context *ctx, ggml_tensor *dst)
+{
+    const ggml_tensor *src0 = dst->src[0];
+    const int64_t ne0 = src0->ne[0];
+
+    if (dst->op == GGML_OP_ARGMAX) {
+        parallel_for(ctx, src0->ne[1], 1, [&](size_t r0, size_t r1) {
+            for (size_t r = r0; r < r1; r++) {
+                const char *row = (const char *)src0->data + r * src0->nb[1];
+                int32_t best = 0;
+                for (int64_t i0 = 1; i0 < ne0; i0++)
+                    if (at_f32(row, src0, i0) > at_f32(row, src0, best))
+                        best = (int32_t)i0;
+                ((int32_t *)dst->data)[r] = best;
+            }
+        });
+        return;
+    }
+
+    // ARGSORT
+    const bool desc = ggml_get_op_params_i32(dst, 0) == GGML_SORT_ORDER_DESC;
+    parallel_for(ctx, ggml_nrows(dst), 1, [&](size_t r0, size_t r1) {
+        for (size_t r = r0; r < r1; r++) {
+            const int64_t i1 = r % dst->ne[1];
+            const int64_t i2 = (r / dst->ne[1]) % dst->ne[2];
+            const int64_t i3 = r / (dst->ne[1] * dst->ne[2]);
+            const char *row = row_ptr(src0, i1, i2, i3);
+            int32_t *d = (int32_t *)row_ptr(dst, i1, i2, i3);
+
+            for (int64_t i0 = 0; i0 < ne0; i0++)
+                d[i0] = (int32_t)i0;
+            std::stable_sort(d, d + ne0, [&](int32_t a, int32_t b) {
+                return desc ? at_f32(row, src0, a) > at_f32(row, src0, b)
+                            : at_f32(row, src0, a) < at_f32(row, src0, b);
+            });
+        }
+    });
+}
+
+bool ggml_backend_gemmini_elementwise_supported(const ggml_tensor *op)
+{
+    const ggml_tensor *src0 = op->src[0];
+    const ggml_tensor *src1 = op->src[1];
+
+    if (op->type != GGML_TYPE_F32 || src0->type != GGML_TYPE_F32 || !ggml_is_contiguous(op))
+        return false;
+
+    switch (op->op) {
+    case GGML_OP_MUL:
+        return src1->type == GGML_TYPE_F32 &&
+               ggml_are_same_shape(src0, op) &&
+               ggml_can_repeat(src1, src0);
+
+    case GGML_OP_UNARY:
+        return ggml_get_unary_op(op) == GGML_UNARY_OP_SILU &&
+               ggml_are_same_shape(src0, op);
+
+    case GGML_OP_GLU:
+        if (ggml_get_glu_op(op) != GGML_GLU_OP_SWIGLU)
+            return false;
+        if (src1)
+            return src1->type == GGML_TYPE_F32 &&
+                   ggml_are_same_shape(src0, op) && ggml_are_same_shape(src1, op);
+        return src0->ne[0] == 2 * op->ne[0] &&
+               ggml_nrows(src0) == ggml_nrows(op);
+
+    default:
+        return false;
+    }
+}
+
+void ggml_backend_gemmini_elementwise(ggml_backend_gemmini_context *ctx, ggml_tensor *dst)
+{
+    const ggml_tensor *src0 = dst->src[0];
+    const ggml_tensor *src1 = dst->src[1];
+    const int64_t ne0 = dst->ne[0];
+
+    // GLU 단일 입력 : 앞 / 뒤 절반이 gate / up (swapped 면 반대)
+    const bool swapped = dst->op == GGML_OP_GLU && ggml_get_op_params_i32(dst, 1) != 0;
+    const int64_t g_off = (dst->op == GGML_OP_GLU && !src1 && swapped) ? ne0 : 0;
+    const int64_t u_off = (dst->op == GGML_OP_GLU && !src1 && !swapped) ? ne0 : 0;
+
+    parallel_for(ctx, ggml_nrows(dst), 1, [&](size_t r0, size_t r1) {
+        for (size_t r = r0; r < r1; r++) {
+            const int64_t i1 = r % dst->ne[1];
+            const int64_t i2 = (r / dst->ne[1]) % dst->ne[2];
+            const int64_t i3 = r / (dst->ne[1] * dst->ne[2]);
+
+            float *d = (float *)row_ptr(dst, i1, i2, i3);
+            const char *a = row_ptr(src0, i1, i2, i3);
+
+            switch (dst->op) {
+            case GGML_OP_MUL: {
+                const char *b = row_ptr(src1, i1, i2, i3);
+                for (int64_t i0 = 0; i0 < ne0; i0++)
+                    d[i0] = at_f32(a, src0, i0) * at_f32(b, src1, i0 % src1->ne[0]);
+                break;
+            }
+            case GGML_OP_UNARY:
+                for (int64_t i0 = 0; i0 < ne0; i0++)
+                    d[i0] = silu_f32(at_f32(a, src0, i0));
+                break;
+
+            case GGML_OP_GLU: {
+                const ggml_tensor *ut = src1 ? src1 : src0;
+                const char *b = src1 ? row_ptr(src1, i1, i2, i3) : a;
+                for (int64_t i0 = 0; i0 < ne0; i0++)
+                    d[i0] = silu_f32(at_f32(a, src0, i0 + g_off)) * at_f32(b, ut, i0 + u_off);
+                break;
+            }
+            default:
+                GGML_ABORT("%s: unsupported op %s", __func__, ggml_op_desc(dst));
+            }
+        }
+    });
+}
@@ -0,0 +1,65 @@
+// ggml-gemmini-fused.h
+#ifndef __GGML_GEMMINI_FUSED_H__
+#define __GGML_GEMMINI_FUSED_H__
+
+#include "ggml.h"
+#include "ggml-gemmini-util.h"
+
+// node 가 gated FFN 패턴의 출력이면 true (중간 결과는 모두 이 패턴에서만 쓰여야 함)
+bool ggml_backend_gemmini_match_ffn(const ggml_tensor *node,
+                                    const std::map<const ggml_tensor *, int> &n_uses,
+                                    ggml_gemmini_ffn_match &m);
+
+// gate | up weight 를 나란히 붙인 B panel 로 matmul 한 번 + silu(gate) * up epilogue
+void ggml_backend_gemmini_ffn(ggml_backend_gemmini_context *ctx, ggml_tensor *dst, const ggml_gemmini_ffn_match &m);
+
+// 같은 src1 을 쓰는 sibling MUL_MAT (Q / K / V projection 등) 을 묶어 ctx->mm_groups 에 기록
+//   bias_map / fused_out 이 정해진 뒤에 호출 (묶음의 마지막이 아닌 MUL_MAT 은 fused_nodes 로)
+void ggml_backend_gemmini_plan_mul_mat_groups(ggml_backend_gemmini_context *ctx, ggml_cgraph *cgraph);
+
+// 묶음의 weight 를 이어 붙인 panel 로 activation staging 1 번 + matmul 1 번,
+// 결과 열 구간을 각 MUL_MAT (또는 fusion 된 ADD) 로 분배
+void ggml_backend_gemmini_mul_mat_group(ggml_backend_gemmini_context *ctx, const std::vector<ggml_tensor *> &mms);
+
+// int8 결과 C (행 stride sC) -> out (2D F32). rope 가 있으면 같은 행에서 바로 RoPE 적용
+void ggml_backend_gemmini_store_rows(ggml_backend_gemmini_context *ctx, const int8_t *C, size_t sC,
+                                     ggml_tensor *out, const ggml_tensor *rope);
+
+// ROPE : normal / NEOX 모드 (YaRN, freq factor 포함)
+bool ggml_backend_gemmini_rope_supported(const ggml_tensor *op);
+
+// ROPE(RESHAPE(MUL_MAT)) 이면 writeback epilogue 로 흡수할 MUL_MAT 을, 아니면 nullptr 반환
+//   bias ADD 가 MUL_MAT 에 fusion 된 경우 (ROPE(RESHAPE(ADD))) 도 포함
+ggml_tensor *ggml_backend_gemmini_match_rope(const ggml_backend_gemmini_context *ctx,
+                                             const ggml_tensor *rope,
+                                             const std::map<const ggml_tensor *, int> &n_uses,
+                                             const std::map<const ggml_tensor *, int> &node_idx);
+
+// GGML_OP_ROPE (epilogue 로 흡수되지 않은 경우)
+void ggml_backend_gemmini_rope(ggml_backend_gemmini_context *ctx, ggml_tensor *dst);
+
+// ARGMAX(MUL_MAT) / ggml_top_k 의 VIEW(ARGSORT(MUL_MAT)) 이면 true (mm : LM head MUL_MAT)
+//   선택 노드가 MUL_MAT 바로 다음 (view 제외) 이어야 함 : 결과를 MUL_MAT 위치에서 기록
+bool ggml_backend_gemmini_match_lm_head(const ggml_cgraph *cgraph,
+                                        const ggml_tensor *node,
+                                        const std::map<const ggml_tensor *, int> &n_uses,
+                                        const std::map<const ggml_tensor *, int> &node_idx,
+                                        ggml_tensor *&mm,
+                                        ggml_gemmini_lm_head &h);
+
+// vocab 을 chunk 단위로 matmul 하며 running top-k 유지, full logits 는 h.logits 일 때만 기록
+void ggml_backend_gemmini_lm_head(ggml_backend_gemmini_context *ctx, ggml_tensor *mm, const ggml_gemmini_lm_head &h);
+
+// MUL_MAT_ID (MoE) : token 을 routing 된 expert 별로 모아 expert 당 matmul 한 번
+bool ggml_backend_gemmini_mul_mat_id_supported(const ggml_tensor *op);
+void ggml_backend_gemmini_mul_mat_id(ggml_backend_gemmini_context *ctx, ggml_tensor *dst);
+
+// ARGMAX / ARGSORT : LM head 에 흡수되지 않은 경우의 host fallback
+bool ggml_backend_gemmini_select_supported(const ggml_tensor *op);
+void ggml_backend_gemmini_select(ggml_backend_gemmini_context *ctx, ggml_tensor *dst);
+
+// MUL / UNARY(SILU) / GLU(SWIGLU) : 패턴에 포함되지 않은 경우의 host fallback
+bool ggml_backend_gemmini_elementwise_supported(const ggml_tensor *op);
+void ggml_backend_gemmini_elementwise(ggml_backend_gemmini_context *ctx, ggml_tensor *dst);
+
+#endif // __GGML_GEMMINI_FUSED_H__
@@ -0,0 +1,77 @@
+// ggml-gemmini-gemv.cpp
+#include "ggml-gemmini-gemv.h"
+#include "ggml-gemmini-tensor.h"
+
+#include <optional>
+#include <vector>
+
+using namespace zerogod;
+
+// GEMV 경로를 고려할 최대 token 수 (그 이상은 Gemmini 가 항상 유리하다고 봄)
+#ifndef GGML_GEMMINI_GEMV_MAX_I
+#define GGML_GEMMINI_GEMV_MAX_I 4
+#endif
+
+bool ggml_backend_gemmini_gemv_preferred(const ggml_backend_gemmini_context *ctx, const ggml_tensor *w, size_t I)
+{
+    const size_t J = w->ne[1], K = w->ne[0];
+
+    if (I > GGML_GEMMINI_GEMV_MAX_I || !ggml_is_matrix(w) ||
+        (w->type != GGML_TYPE_F32 && w->type != GGML_TYPE_F16))
+        return false;
+
+    // 두 경로 모두 같은 K x J int8 weight (GEMMINI_LAYOUT_MUL_MAT) 를 읽음
+    //   cache 되는 weight 는 변환이 한 번뿐이라 호출마다의 비용에서 빠지고, 아니면 양쪽 모두 매번 변환
+    // Gemmini : I 를 DIM 으로 padding 한 matmul
+    // GEMV    : weight 를 한 번 읽으며 I 개 token 을 누적
+    const ggml_gemmini_cost_model &cm = ctx->cost;
+    const double w_stage = ggml_gemmini_weight_cache::cacheable(w) ? 0.0 : cm.stage(K * J, ctx->n_threads);
+    const double acc = cm.matmul(I, J, K) + w_stage;
+    const double host = cm.host_gemv(I, J, K, ctx->n_threads) + w_stage;
+
+    DBG("[Gemmini] gemv cost: %s I=%zu J=%zu K=%zu gemmini=%.0f host=%.0f\n", w->name, I, J, K, acc, host);
+    return host < acc;
+}
+
+void ggml_backend_gemmini_gemv(ggml_backend_gemmini_context *ctx, const ggml_tensor *w,
+                               const int8_t *A, size_t sA, size_t I,
+                               const int32_t *D, size_t sD, bool repeating,
+                               int8_t *C, size_t sC)
+{
+    DBG("[Gemmini] gemv call: %s\n", w->name);
+
+    const size_t K = w->ne[0], J = w->ne[1];
+
+    std::optional<ggml_gemmini_tensor<int8_t>> local;
+    const ggml_gemmini_tensor<int8_t> &tW = ctx->weight_cache->stage(ctx->tmp_ctx, w, GEMMINI_LAYOUT_MUL_MAT, local,
+                                                                     [&](ggml_context *c) {
+        return ggml_gemmini_tensor<int8_t>(c, w, ".i8", false, true);
+    });
+    const int8_t *W = static_cast<const int8_t *>(tW.get());
+    const size_t sW = tW.get_stride();
+
+    // 열 구간을 thread 별로 나누고 weight 행 k 의 구간을 한 번 읽어 I 개 token 에 누적 (안쪽 loop 가 연속 메모리)
+    parallel_for(ctx, J, 64, [&](size_t m0, size_t m1) {
+        const size_t n = m1 - m0;
+        std::vector<int32_t> acc(I * n);
+        if (D)
+            for (size_t i = 0; i < I; i++)
+                std::copy_n(D + (repeating ? 0 : i * sD) + m0, n, acc.begin() + i * n);
+
+        for (size_t k = 0; k < K; k++) {
+            const int8_t *wrow = W + k * sW + m0;
+            for (size_t i = 0; i < I; i++) {
+                const int32_t a = A[i * sA + k];
+                if (a == 0)
+                    continue;
+                int32_t *c = acc.data() + i * n;
+                for (size_t m = 0; m < n; m++)
+                    c[m] += a * wrow[m];
+            }
+        }
+
+        for (size_t i = 0; i < I; i++)
+            for (size_t m = 0; m < n; m++)
+                C[i * sC + m0 + m] = static_cast<int8_t>(std::clamp<int32_t>(acc[i * n + m], -128, 127));
+    });
+}
@@ -0,0 +1,19 @@
+// ggml-gemmini-gemv.h
+#ifndef __GGML_GEMMINI_GEMV_H__
+#define __GGML_GEMMINI_GEMV_H__
+
+#include "ggml.h"
+#include "ggml-gemmini-util.h"
+
+// batch-1 decode 처럼 token 수 I 가 작은 weight w 의 MUL_MAT 을 host int8 GEMV 로 돌릴지 (ctx->cost 로 판단)
+bool ggml_backend_gemmini_gemv_preferred(const ggml_backend_gemmini_context *ctx, const ggml_tensor *w, size_t I);
+
+// C (I x J int8, 행 stride sC) = sat8(A (I x K int8) * W^T + D) : tiled_matmul_auto 와 같은 결과
+//   W 는 ggml weight w [K, J] 를 Gemmini matmul 과 같은 K x J int8 로 둔 것 (weight buffer 면 cache 를 공유)
+//   D 는 optional int32 bias / residual (repeating 이면 1 행)
+void ggml_backend_gemmini_gemv(ggml_backend_gemmini_context *ctx, const ggml_tensor *w,
+                               const int8_t *A, size_t sA, size_t I,
+                               const int32_t *D, size_t sD, bool repeating,
+                               int8_t *C, size_t sC);
+
+#endif // __GGML_GEMMINI_GEMV_H__
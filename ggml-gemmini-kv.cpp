@@ -0,0 +1,501 @@
+// ggml-gemmini-kv.cpp
+#include "ggml-gemmini-kv.h"
+#include "ggml-gemmini-device.h"
+#include "gemmini.h"
+
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <optional>
+
+using namespace zerogod;
+
+// page shift 하한 : |x| <= 127 * 2^-16 인 page 는 이 정밀도로 충분
+#ifndef GGML_GEMMINI_KV_SHIFT_MIN
+#define GGML_GEMMINI_KV_SHIFT_MIN -16
+#endif
+
+namespace
+{
+    inline void set_f32(ggml_type type, char *p, float v)
+    {
+        if (type == GGML_TYPE_F16)
+            *(ggml_fp16_t *)p = ggml_fp32_to_fp16(v);
+        else
+            *(float *)p = v;
+    }
+
+    inline float load_f32(ggml_type type, const char *row, size_t l)
+    {
+        return type == GGML_TYPE_F16 ? ggml_fp16_to_fp32(((const ggml_fp16_t *)row)[l]) : ((const float *)row)[l];
+    }
+
+    // |x| <= max_abs 를 int8 에 담는 가장 작은 shift (음수면 확대해서 저장)
+    int page_shift(float max_abs)
+    {
+        int shift = GGML_GEMMINI_KV_SHIFT_MIN;
+        while (shift < 31 && max_abs > std::ldexp(127.0f, shift))
+            shift++;
+        return shift;
+    }
+
+    // src0 (KV view) 의 head h 시작 원소 : root 메모리 기준 (행 r0, 열 l0)
+    inline void kv_head_origin(const ggml_tensor *src0, size_t row_len, int64_t h, size_t &r0, size_t &l0)
+    {
+        const size_t e = (src0->view_offs + h * src0->nb[2]) / ggml_type_size(src0->type);
+        r0 = e / row_len;
+        l0 = e % row_len;
+    }
+
+    // B panel 의 연속된 열 구간 : C 의 열 m0 부터 len 열
+    struct kv_segment
+    {
+        const int8_t *B;
+        size_t m0, len;
+    };
+
+    // 모든 backend 의 등록 KV root
+    std::mutex kv_roots_mtx;
+    std::set<const ggml_tensor *> kv_roots;
+}
+
+// ______________________page pool______________________
+ggml_gemmini_kv_pool::ggml_gemmini_kv_pool(ggml_context *ctx, size_t row_len)
+    : ctx_(ctx), row_len_(row_len)
+{
+}
+
+int32_t ggml_gemmini_kv_pool::alloc()
+{
+    if (free_.empty()) {
+        // 새 chunk 만 추가 : 이미 쓰고 있는 page 는 이동하지 않음
+        chunks_.emplace_back(ctx_, "kv_pool", row_len_, (size_t)GGML_GEMMINI_KV_POOL_CHUNK * GGML_GEMMINI_KV_PAGE_ROWS);
+        stride_ = chunks_.back().get_stride();
+
+        const int32_t base = (int32_t)shift_.size();
+        shift_.resize(base + GGML_GEMMINI_KV_POOL_CHUNK, 0);
+        for (int32_t p = base + GGML_GEMMINI_KV_POOL_CHUNK - 1; p >= base; p--)
+            free_.push_back(p);
+    }
+
+    const int32_t p = free_.back();
+    free_.pop_back();
+    return p;
+}
+
+void ggml_gemmini_kv_pool::release(int32_t p)
+{
+    free_.push_back(p);
+}
+
+int8_t *ggml_gemmini_kv_pool::page(int32_t p)
+{
+    return static_cast<int8_t *>(chunks_[p / GGML_GEMMINI_KV_POOL_CHUNK].get()) +
+           (size_t)(p % GGML_GEMMINI_KV_POOL_CHUNK) * GGML_GEMMINI_KV_PAGE_ROWS;
+}
+
+// ______________________KV staging______________________
+ggml_gemmini_kv_stage::ggml_gemmini_kv_stage(ggml_gemmini_kv_pool &pool, const ggml_tensor *root, size_t row_len)
+    : pool_(pool),
+      root_(root),
+      data_(root->data),
+      row_len_(row_len),
+      n_rows_(ggml_nbytes(root) / (row_len * ggml_type_size(root->type))),
+      row_bytes_(row_len * ggml_type_size(root->type)),
+      table_((n_rows_ + GGML_GEMMINI_KV_PAGE_ROWS - 1) / GGML_GEMMINI_KV_PAGE_ROWS, -1),
+      n_valid_(table_.size(), 0),
+      valid_(n_rows_, 0)
+{
+}
+
+ggml_gemmini_kv_stage::~ggml_gemmini_kv_stage()
+{
+    for (int32_t p : table_)
+        if (p >= 0)
+            pool_.release(p);
+}
+
+void ggml_gemmini_kv_stage::quantize_row(size_t r, int32_t p)
+{
+    int8_t *P = pool_.page(p) + r % GGML_GEMMINI_KV_PAGE_ROWS;
+    const size_t stride = pool_.stride();
+    const int shift = pool_.shift(p);
+    const char *src = (const char *)data_ + r * row_bytes_;
+
+    for (size_t l = 0; l < row_len_; l++) {
+        const long q = std::lrint(std::ldexp(load_f32(root_->type, src, l), -shift));
+        P[l * stride] = static_cast<int8_t>(std::clamp(q, -127l, 127l));
+    }
+}
+
+size_t ggml_gemmini_kv_stage::update(size_t r0, size_t r1)
+{
+    const size_t PR = GGML_GEMMINI_KV_PAGE_ROWS;
+    r1 = std::min(r1, n_rows_);
+
+    size_t n = 0;
+    for (size_t lo = r0 / PR * PR; lo < r1; lo += PR) {
+        const size_t lp = lo / PR, hi = std::min(lo + PR, n_rows_);
+        const size_t a = std::max(lo, r0), b = std::min(hi, r1);
+
+        bool dirty = false;
+        float max_abs = 0.0f;
+        for (size_t r = a; r < b; r++) {
+            if (valid_[r])
+                continue;
+            dirty = true;
+            const char *src = (const char *)data_ + r * row_bytes_;
+            for (size_t l = 0; l < row_len_; l++)
+                max_abs = std::max(max_abs, std::fabs(load_f32(root_->type, src, l)));
+        }
+        if (!dirty)
+            continue;
+
+        int32_t &p = table_[lp];
+        if (p < 0)
+            p = pool_.alloc();
+
+        // 새 행이 현재 scale 을 넘으면 page 전체를 더 큰 shift 로
+        const int shift = page_shift(max_abs);
+        if (n_valid_[lp] == 0) {
+            pool_.shift(p) = shift;
+        } else if (shift > pool_.shift(p)) {
+            pool_.shift(p) = shift;
+            for (size_t r = lo; r < hi; r++)
+                if (valid_[r]) {
+                    quantize_row(r, p);
+                    n++;
+                }
+        }
+
+        for (size_t r = a; r < b; r++)
+            if (!valid_[r]) {
+                quantize_row(r, p);
+                valid_[r] = 1;
+                n_valid_[lp]++;
+                n++;
+            }
+    }
+    return n;
+}
+
+void ggml_gemmini_kv_stage::invalidate(size_t b0, size_t b1)
+{
+    if (b1 <= b0)
+        return;
+    const size_t r0 = std::min(n_rows_, b0 / row_bytes_);
+    const size_t r1 = std::min(n_rows_, b1 / row_bytes_ + (b1 % row_bytes_ != 0));
+
+    for (size_t r = r0; r < r1; r++) {
+        if (!valid_[r])
+            continue;
+        valid_[r] = 0;
+
+        const size_t lp = r / GGML_GEMMINI_KV_PAGE_ROWS;
+        if (--n_valid_[lp] == 0) {
+            pool_.release(table_[lp]);
+            table_[lp] = -1;
+        }
+    }
+}
+
+ggml_gemmini_kv_cache::ggml_gemmini_kv_cache(size_t max_tensors)
+{
+    struct ggml_init_params ip = {
+        /* .mem_size   = */ max_tensors * ggml_tensor_overhead(),
+        /* .mem_buffer = */ NULL,
+        /* .no_alloc   = */ true, // 헤더만
+    };
+
+    ctx_ = ggml_init(ip);
+    GGML_ASSERT(ctx_);
+}
+
+ggml_gemmini_kv_cache::~ggml_gemmini_kv_cache()
+{
+    stages_.clear(); // page 를 pool 로 반환한 뒤 pool 해제
+    pools_.clear();
+    ggml_free(ctx_);
+}
+
+void ggml_gemmini_kv_cache::reg(const ggml_tensor *root)
+{
+    registered_.insert(root);
+
+    std::lock_guard<std::mutex> lock(kv_roots_mtx);
+    kv_roots.insert(root);
+}
+
+bool ggml_gemmini_kv_cache::registered_any(const ggml_tensor *root)
+{
+    std::lock_guard<std::mutex> lock(kv_roots_mtx);
+    return kv_roots.count(root) != 0;
+}
+
+void ggml_gemmini_kv_cache::invalidate(const ggml_tensor *root, size_t b0, size_t b1)
+{
+    auto it = stages_.find(root);
+    if (it != stages_.end())
+        it->second->invalidate(b0, b1);
+}
+
+void ggml_gemmini_kv_cache::on_write(const ggml_tensor *node)
+{
+    if (is_view_op(node) || node->view_src == nullptr)
+        return;
+
+    const ggml_tensor *root = view_root(node);
+    if (!registered(root) || stages_.count(root) == 0)
+        return;
+
+    const size_t base = (const char *)node->data - (const char *)root->data;
+    const size_t row = (node->ne[0] - 1) * node->nb[0] + ggml_type_size(node->type);
+
+    if (node->op == GGML_OP_SET_ROWS) {
+        // index 가 가리키는 dst 행만
+        const ggml_tensor *src0 = node->src[0];
+        const ggml_tensor *idx = node->src[1];
+        for (int64_t i03 = 0; i03 < src0->ne[3]; i03++)
+            for (int64_t i02 = 0; i02 < src0->ne[2]; i02++)
+                for (int64_t i = 0; i < src0->ne[1]; i++) {
+                    const char *ip = (const char *)idx->data + i * idx->nb[0] +
+                                     (i02 % idx->ne[1]) * idx->nb[1] + (i03 % idx->ne[2]) * idx->nb[2];
+                    const int64_t r = idx->type == GGML_TYPE_I64 ? *(const int64_t *)ip : *(const int32_t *)ip;
+                    const size_t off = base + r * node->nb[1] + i02 * node->nb[2] + i03 * node->nb[3];
+                    invalidate(root, off, off + row);
+                }
+        return;
+    }
+
+    // 그 밖의 쓰기 : view 가 걸친 byte 범위 전체
+    size_t extent = row;
+    for (int d = 1; d < GGML_MAX_DIMS; d++)
+        extent += (node->ne[d] - 1) * node->nb[d];
+    invalidate(root, base, base + extent);
+}
+
+ggml_gemmini_kv_stage *ggml_gemmini_kv_cache::get(const ggml_tensor *root, size_t row_len)
+{
+    if (!registered(root))
+        return nullptr;
+
+    auto &pool = pools_[row_len];
+    if (!pool)
+        pool = std::make_unique<ggml_gemmini_kv_pool>(ctx_, row_len);
+
+    auto &stage = stages_[root];
+    if (!stage || !stage->matches(root, row_len)) {
+        stage.reset(); // 이전 page 를 먼저 반환해 재사용
+        stage = std::make_unique<ggml_gemmini_kv_stage>(*pool, root, row_len);
+    }
+    return stage.get();
+}
+
+// ______________________backend ops______________________
+bool ggml_backend_gemmini_kv_mul_mat_supported(const ggml_tensor *op)
+{
+    const ggml_tensor *src0 = op->src[0];
+    const ggml_tensor *src1 = op->src[1];
+    const ggml_tensor *root = view_root(src0);
+    const size_t elt = ggml_type_size(src0->type);
+
+    if (src0 == root || root->type != src0->type || !ggml_is_contiguous(root) ||
+        (src0->type != GGML_TYPE_F32 && src0->type != GGML_TYPE_F16) ||
+        src1->type != GGML_TYPE_F32 || op->type != GGML_TYPE_F32 ||
+        src0->nb[0] != elt || src0->nb[1] % elt != 0 ||
+        src0->ne[3] != 1 || src1->ne[3] != 1 || src1->ne[2] % src0->ne[2] != 0)
+        return false;
+
+    // 각 head 가 root 메모리의 (연속된 행, 한 행 안의 열 구간) 으로 표현되어야 함
+    const size_t L = src0->nb[1] / elt;
+    if (ggml_nbytes(root) % (L * elt) != 0 || (size_t)src0->ne[0] > L)
+        return false;
+
+    const size_t R = ggml_nbytes(root) / (L * elt);
+    for (int64_t h = 0; h < src0->ne[2]; h++) {
+        if ((src0->view_offs + h * src0->nb[2]) % elt != 0)
+            return false;
+        size_t r0, l0;
+        kv_head_origin(src0, L, h, r0, l0);
+        if (l0 + src0->ne[0] > L || r0 + src0->ne[1] > R)
+            return false;
+    }
+    return true;
+}
+
+void ggml_backend_gemmini_kv_mul_mat(ggml_backend_gemmini_context *ctx, ggml_tensor *dst)
+{
+    // dst[:, :, h1] = src0[:, :, h1 / bcast]^T * src1[:, :, h1]
+    const ggml_tensor *src0 = dst->src[0]; // KV view [K, M, H0]
+    const ggml_tensor *src1 = dst->src[1]; // [K, N, H1]
+    const ggml_tensor *root = view_root(src0);
+
+    const size_t K = src0->ne[0], M = src0->ne[1], N = src1->ne[1];
+    const int64_t H1 = src1->ne[2], bcast = src1->ne[2] / src0->ne[2];
+    const size_t L = src0->nb[1] / ggml_type_size(src0->type);
+    const size_t PR = GGML_GEMMINI_KV_PAGE_ROWS;
+
+    ggml_gemmini_kv_stage *stage = ctx->kv_cache->get(root, L);
+    DBG("[Gemmini] kv mul_mat call: %s (%s)\n", dst->name, stage ? "paged" : "full");
+
+    ggml_gemmini_tensor<int8_t> tA(ctx->tmp_ctx, src1->name, N, K);
+    ggml_gemmini_tensor<int32_t> tC(ctx->tmp_ctx, dst->name, N, M);
+    int8_t *A = static_cast<int8_t *>(tA.get());
+    int32_t *C = static_cast<int32_t *>(tC.get());
+    const size_t sA = tA.get_stride(), sC = tC.get_stride();
+
+    std::optional<ggml_gemmini_tensor<int8_t>> local; // 미등록 텐서 : head 마다 새로 pack
+    std::vector<kv_segment> segs;
+    std::vector<float> scale(M, 1.0f); // C 열 m 의 page scale 2^shift
+    size_t sB = 0, requant = 0;
+
+    for (int64_t h1 = 0; h1 < H1; h1++) {
+        const int64_t h0 = h1 / bcast;
+
+        if (h1 % bcast == 0) {
+            segs.clear();
+            if (stage) {
+                size_t r0, l0;
+                kv_head_origin(src0, L, h0, r0, l0);
+                requant += stage->update(r0, r0 + M);
+
+                // block table 을 따라 page 구간 나열, pool 에서 이어진 page 는 한 구간으로
+                ggml_gemmini_kv_pool &pool = stage->pool();
+                sB = pool.stride();
+                for (size_t m = 0; m < M;) {
+                    const size_t r = r0 + m, len = std::min(PR - r % PR, M - m);
+                    const int32_t p = stage->page_of(r);
+                    const int8_t *B = pool.page(p) + l0 * sB + r % PR;
+
+                    if (!segs.empty() && segs.back().B + segs.back().len == B)
+                        segs.back().len += len;
+                    else
+                        segs.push_back({B, m, len});
+
+                    std::fill(scale.begin() + m, scale.begin() + m + len, std::ldexp(1.0f, pool.shift(p)));
+                    m += len;
+                }
+            } else {
+                local.emplace(ctx->tmp_ctx, src0->name, K, M);
+                int8_t *w = static_cast<int8_t *>(local->get());
+                sB = local->get_stride();
+                for (size_t m = 0; m < M; m++)
+                    for (size_t k = 0; k < K; k++)
+                        w[k * sB + m] = static_cast<int8_t>(get_f32(src0, k, m, h0));
+                segs.push_back({w, 0, M});
+            }
+        }
+
+        parallel_for(ctx, N, 1, [&](size_t n0, size_t n1) {
+            for (size_t n = n0; n < n1; n++)
+                for (size_t k = 0; k < K; k++)
+                    A[n * sA + k] = static_cast<int8_t>(get_f32(src1, k, n, h1));
+        });
+
+        // page 마다 scale 이 다르므로 int32 그대로 받아 epilogue 에서 복원
+        std::unique_lock<std::mutex> own(ggml_gemmini_device_mutex(ctx->device));
+        for (const kv_segment &s : segs)
+            tiled_matmul_auto(N, s.len, K,
+                              (const elem_t *)A, (const elem_t *)s.B, NULL, (acc_t *)(C + s.m0),
+                              sA, sB, 0, sC,
+                              MVIN_SCALE_IDENTITY, MVIN_SCALE_IDENTITY, MVIN_SCALE_IDENTITY,
+                              NO_ACTIVATION,
+                              ACC_SCALE_IDENTITY, 0,
+                              false,
+                              false, false,
+                              true, false, // full_C : int32 그대로
+                              0, GGML_GEMMINI_TYPE);
+        own.unlock();
+
+        parallel_for(ctx, N, 1, [&](size_t n0, size_t n1) {
+            for (size_t n = n0; n < n1; n++) {
+                char *drow = (char *)dst->data + n * dst->nb[1] + h1 * dst->nb[2];
+                for (size_t m = 0; m < M; m++)
+                    *(float *)(drow + m * dst->nb[0]) = (float)C[n * sC + m] * scale[m];
+            }
+        });
+    }
+
+    DBG("[Gemmini] kv mul_mat: %zu rows re-quantized, %zu segments\n", requant, segs.size());
+}
+
+bool ggml_backend_gemmini_kv_write_supported(const ggml_tensor *op)
+{
+    const ggml_tensor *src0 = op->src[0];
+    const bool dst_ok = op->type == GGML_TYPE_F32 || op->type == GGML_TYPE_F16;
+
+    // 등록된 KV 텐서에 쓰는 노드만 : 일반 복사는 CPU backend 에 둔다
+    if (op->view_src == nullptr || !ggml_gemmini_kv_cache::registered_any(view_root(op)))
+        return false;
+
+    switch (op->op) {
+    case GGML_OP_SET_ROWS: {
+        const ggml_tensor *idx = op->src[1];
+        return dst_ok && src0->type == GGML_TYPE_F32 &&
+               (idx->type == GGML_TYPE_I64 || idx->type == GGML_TYPE_I32) &&
+               src0->ne[0] == op->ne[0] && src0->ne[2] == op->ne[2] && src0->ne[3] == op->ne[3] &&
+               idx->ne[0] == src0->ne[1] && src0->ne[2] % idx->ne[1] == 0 && src0->ne[3] % idx->ne[2] == 0;
+    }
+    case GGML_OP_CPY:
+        return dst_ok && (src0->type == GGML_TYPE_F32 || src0->type == GGML_TYPE_F16) &&
+               ggml_nelements(src0) == ggml_nelements(op);
+
+    default:
+        return false;
+    }
+}
+
+void ggml_backend_gemmini_kv_write(ggml_backend_gemmini_context *ctx, ggml_tensor *dst)
+{
+    const ggml_tensor *src0 = dst->src[0];
+    const int64_t ne00 = src0->ne[0], ne01 = src0->ne[1], ne02 = src0->ne[2];
+
+    if (dst->op == GGML_OP_SET_ROWS) {
+        // dst[:, idx[i, i02, i03], i02, i03] = src0[:, i, i02, i03]
+        const ggml_tensor *idx = dst->src[1];
+        parallel_for(ctx, ggml_nrows(src0), 1, [&](size_t r0, size_t r1) {
+            for (size_t r = r0; r < r1; r++) {
+                const int64_t i = r % ne01, i02 = (r / ne01) % ne02, i03 = r / (ne01 * ne02);
+                const char *ip = (const char *)idx->data + i * idx->nb[0] +
+                                 (i02 % idx->ne[1]) * idx->nb[1] + (i03 % idx->ne[2]) * idx->nb[2];
+                const int64_t row = idx->type == GGML_TYPE_I64 ? *(const int64_t *)ip : *(const int32_t *)ip;
+
+                char *d = (char *)dst->data + row * dst->nb[1] + i02 * dst->nb[2] + i03 * dst->nb[3];
+                for (int64_t i0 = 0; i0 < ne00; i0++)
+                    set_f32(dst->type, d + i0 * dst->nb[0], get_f32(src0, i0, i, i02, i03));
+            }
+        });
+        return;
+    }
+
+    // CPY : 원소를 논리 순서대로 (shape 이 달라도 원소 수만 같으면 됨)
+    if (ggml_is_contiguous(dst)) {
+        // 연속된 dst (KV slot 구간) : 논리 순서 = 메모리 순서
+        const size_t ts = ggml_type_size(dst->type);
+        parallel_for(ctx, ggml_nrows(src0), 1, [&](size_t r0, size_t r1) {
+            for (size_t r = r0; r < r1; r++) {
+                const int64_t i1 = r % ne01, i2 = (r / ne01) % ne02, i3 = r / (ne01 * ne02);
+                char *d = (char *)dst->data + r * ne00 * ts;
+                for (int64_t i0 = 0; i0 < ne00; i0++)
+                    set_f32(dst->type, d + i0 * ts, get_f32(src0, i0, i1, i2, i3));
+            }
+        });
+        return;
+    }
+
+    parallel_for(ctx, ggml_nrows(src0), 1, [&](size_t r0, size_t r1) {
+        for (size_t r = r0; r < r1; r++) {
+            const int64_t i1 = r % ne01, i2 = (r / ne01) % ne02, i3 = r / (ne01 * ne02);
+            for (int64_t i0 = 0; i0 < ne00; i0++) {
+                int64_t lin = (int64_t)r * ne00 + i0;
+                const int64_t d0 = lin % dst->ne[0]; lin /= dst->ne[0];
+                const int64_t d1 = lin % dst->ne[1]; lin /= dst->ne[1];
+                const int64_t d2 = lin % dst->ne[2]; lin /= dst->ne[2];
+                const int64_t d3 = lin;
+                set_f32(dst->type,
+                        (char *)dst->data + d0 * dst->nb[0] + d1 * dst->nb[1] + d2 * dst->nb[2] + d3 * dst->nb[3],
+                        get_f32(src0, i0, i1, i2, i3));
+            }
+        }
+    });
+}
@@ -0,0 +1,153 @@
+// ggml-gemmini-kv.h
+#ifndef __GGML_GEMMINI_KV_H__
+#define __GGML_GEMMINI_KV_H__
+
+#include "ggml.h"
+#include "ggml-gemmini-util.h"
+#include "ggml-gemmini-tensor.h"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+
+// page 하나가 담는 메모리 행 수 (= B panel 의 열 16 개, DIM tile 하나)
+#ifndef GGML_GEMMINI_KV_PAGE_ROWS
+#define GGML_GEMMINI_KV_PAGE_ROWS 16
+#endif
+
+// pool 이 모자랄 때 한 번에 늘리는 page 수 (기존 chunk 는 옮기지 않음)
+#ifndef GGML_GEMMINI_KV_POOL_CHUNK
+#define GGML_GEMMINI_KV_POOL_CHUNK 64
+#endif
+
+namespace zerogod
+{
+    // 행 길이 L 이 같은 KV staging 이 공유하는 int8 page pool
+    //   chunk : L x (CHUNK * PAGE_ROWS) panel (ggml_gemmini_tensor 의 16 B 정렬 layout)
+    //   page p : chunk p / CHUNK 의 열 (p % CHUNK) * PAGE_ROWS 부터 PAGE_ROWS 열
+    //   page 마다 shift s : 저장값 = round(x / 2^s) (s < 0 이면 확대)
+    class ggml_gemmini_kv_pool
+    {
+    public:
+        ggml_gemmini_kv_pool(ggml_context *ctx, size_t row_len);
+
+        ggml_gemmini_kv_pool(const ggml_gemmini_kv_pool &) = delete;
+        ggml_gemmini_kv_pool &operator=(const ggml_gemmini_kv_pool &) = delete;
+
+        int32_t alloc();
+        void release(int32_t p);
+
+        // page p 의 (0, 0) 원소, 행 stride 는 stride()
+        int8_t *page(int32_t p);
+        size_t stride() const { return stride_; }
+
+        int &shift(int32_t p) { return shift_[p]; }
+        int shift(int32_t p) const { return shift_[p]; }
+
+        size_t n_pages() const { return shift_.size(); }
+        size_t n_free() const { return free_.size(); }
+
+    private:
+        ggml_context *ctx_;
+        size_t row_len_;
+        size_t stride_ = 0;
+        std::vector<ggml_gemmini_tensor<int8_t>> chunks_;
+        std::vector<int> shift_;
+        std::vector<int32_t> free_;
+    };
+
+    // KV cache 처럼 graph 밖에서 유지되며 조금씩 덧붙여지는 텐서의 int8 staging
+    //   메모리를 길이 L 의 행 R 개로 보고 B layout (P[l][r] = mem[r * L + l]) 으로 보관
+    //   행 r 은 block table 이 가리키는 page 의 열 r % PAGE_ROWS 에 있음 (page 는 처음 쓰일 때 할당)
+    //   메모리 행마다 valid 표시 : 다시 쓰인 행만 양자화하고 나머지는 그대로 재사용
+    class ggml_gemmini_kv_stage
+    {
+    public:
+        ggml_gemmini_kv_stage(ggml_gemmini_kv_pool &pool, const ggml_tensor *root, size_t row_len);
+        ~ggml_gemmini_kv_stage();
+
+        ggml_gemmini_kv_stage(const ggml_gemmini_kv_stage &) = delete;
+        ggml_gemmini_kv_stage &operator=(const ggml_gemmini_kv_stage &) = delete;
+
+        bool matches(const ggml_tensor *root, size_t row_len) const
+        {
+            return root->data == data_ && row_len == row_len_;
+        }
+
+        // 메모리 행 [r0, r1) 중 valid 가 아닌 행을 양자화, 양자화한 행 수 반환
+        //   새 행이 page 의 shift 로 표현되지 않으면 그 page 의 valid 행도 다시 양자화
+        size_t update(size_t r0, size_t r1);
+
+        // byte 구간 [b0, b1) 이 걸친 메모리 행을 무효화 (valid 행이 없는 page 는 pool 로 반환)
+        void invalidate(size_t b0, size_t b1);
+
+        // 메모리 행 r 이 들어 있는 page (update 된 행만)
+        int32_t page_of(size_t r) const { return table_[r / GGML_GEMMINI_KV_PAGE_ROWS]; }
+
+        ggml_gemmini_kv_pool &pool() { return pool_; }
+        const ggml_gemmini_kv_pool &pool() const { return pool_; }
+        size_t row_len() const { return row_len_; }
+        size_t n_rows() const { return n_rows_; }
+
+    private:
+        void quantize_row(size_t r, int32_t p);
+
+        ggml_gemmini_kv_pool &pool_;
+        const ggml_tensor *root_;
+        const void *data_;
+        size_t row_len_;
+        size_t n_rows_;
+        size_t row_bytes_;
+        std::vector<int32_t> table_;    // block table : 논리 page -> pool page (-1 : 미할당)
+        std::vector<uint16_t> n_valid_; // 논리 page 별 valid 행 수
+        std::vector<uint8_t> valid_;
+    };
+
+    // 등록된 KV 텐서별 staging (backend 수명)
+    //   등록하는 쪽은 그 텐서에 대한 쓰기가 이 backend 의 graph (SET_ROWS / CPY) 에서 일어나거나
+    //   invalidate() 로 알려진다는 것을 보장해야 함
+    class ggml_gemmini_kv_cache
+    {
+    public:
+        explicit ggml_gemmini_kv_cache(size_t max_tensors = 4096);
+        ~ggml_gemmini_kv_cache();
+
+        ggml_gemmini_kv_cache(const ggml_gemmini_kv_cache &) = delete;
+        ggml_gemmini_kv_cache &operator=(const ggml_gemmini_kv_cache &) = delete;
+
+        void reg(const ggml_tensor *root);
+        bool registered(const ggml_tensor *root) const { return registered_.count(root) != 0; }
+
+        // 어느 backend 에든 등록된 root 인지 (supports_op 는 backend context 없이 불리므로 process 전체 기준)
+        static bool registered_any(const ggml_tensor *root);
+
+        // root 의 byte 구간 [b0, b1) 이 다시 쓰였음 (기본 : 전체)
+        void invalidate(const ggml_tensor *root, size_t b0 = 0, size_t b1 = SIZE_MAX);
+
+        // node 가 등록된 텐서에 쓰는 연산이면 쓴 구간을 무효화 (노드 실행 후 호출)
+        void on_write(const ggml_tensor *node);
+
+        // 등록된 root 의 행 길이 row_len staging (처음이거나 layout / 주소가 바뀌면 새로 생성)
+        // 등록되지 않은 텐서면 nullptr
+        ggml_gemmini_kv_stage *get(const ggml_tensor *root, size_t row_len);
+
+    private:
+        ggml_context *ctx_ = nullptr; // pool chunk 텐서 헤더용
+        std::set<const ggml_tensor *> registered_;
+        std::map<size_t, std::unique_ptr<ggml_gemmini_kv_pool>> pools_; // 행 길이별
+        std::map<const ggml_tensor *, std::unique_ptr<ggml_gemmini_kv_stage>> stages_;
+    };
+}
+
+// KV view (src0) x activation MUL_MAT : head (ne2) 별 matmul, src1 head 는 GQA broadcast
+//   등록된 KV 는 block table 로 page 를 따라가며 matmul, int32 결과에 page 별 scale 복원
+bool ggml_backend_gemmini_kv_mul_mat_supported(const ggml_tensor *op);
+void ggml_backend_gemmini_kv_mul_mat(ggml_backend_gemmini_context *ctx, ggml_tensor *dst);
+
+// SET_ROWS / CPY : KV 쓰기를 이 backend 에서 실행해 staging 무효화가 보이도록 (dst 가 등록된 KV 의 view 일 때만)
+bool ggml_backend_gemmini_kv_write_supported(const ggml_tensor *op);
+void ggml_backend_gemmini_kv_write(ggml_backend_gemmini_context *ctx, ggml_tensor *dst);
+
+#endif // __GGML_GEMMINI_KV_H__
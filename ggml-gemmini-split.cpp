@@ -0,0 +1,288 @@
+// ggml-gemmini-split.cpp
+#include "ggml-gemmini-split.h"
+#include "ggml-gemmini-tensor.h"
+#include "ggml-gemmini-device.h"
+#include "gemmini.h"
+
+#include <chrono>
+#include <future>
+#include <optional>
+
+using namespace zerogod;
+
+// split-K 를 고려할 최소 K / max(I, J) (deep & narrow : decode 의 down projection 등)
+#ifndef GGML_GEMMINI_SPLIT_K_MIN_RATIO
+#define GGML_GEMMINI_SPLIT_K_MIN_RATIO 4
+#endif
+
+// tensor parallel 로 device 에 나눌 최소 MAC 수
+#ifndef GGML_GEMMINI_TP_MIN_MACS
+#define GGML_GEMMINI_TP_MIN_MACS (1 << 22)
+#endif
+
+// 가속기 / host co-execution 을 고려할 최소 MAC 수 (작으면 thread 기동 비용이 더 큼)
+#ifndef GGML_GEMMINI_COEXEC_MIN_MACS
+#define GGML_GEMMINI_COEXEC_MIN_MACS (1 << 24)
+#endif
+
+namespace
+{
+    using clock_type = std::chrono::steady_clock;
+
+    // tensor parallel 로 쓸 device 수 (1 이면 이 device 만)
+    int tp_devices(const ggml_backend_gemmini_context *ctx)
+    {
+        return ctx->tensor_parallel ? (int)ggml_gemmini_devices().size() : 1;
+    }
+
+    // 동시에 matmul 을 돌릴 수 있는 worker 수 : CPU 모드는 thread 마다, 가속기는 device 마다
+    int split_workers(const ggml_backend_gemmini_context *ctx)
+    {
+        return GGML_GEMMINI_TYPE == CPU ? std::max(ctx->n_threads, 1) : tp_devices(ctx);
+    }
+
+    // fn(0 .. n-1) 을 device ctx->device 부터 n 개에 하나씩 (device 사용권을 이미 잡은 상태)
+    template <typename F>
+    void run_devices(ggml_backend_gemmini_context *ctx, int n, F &&fn)
+    {
+        std::vector<std::function<void()>> jobs;
+        for (int p = 0; p < n; p++)
+            jobs.push_back([&fn, p] { fn(p); });
+        ggml_gemmini_device_pool::instance().run(ctx->device, jobs);
+    }
+
+    // fn(0 .. n-1) 을 worker 에 하나씩 : CPU 모드는 thread pool, 가속기는 device pool
+    //   다른 device 가 사용 중이면 이 device 에서 차례로 실행
+    template <typename F>
+    void run_workers(ggml_backend_gemmini_context *ctx, int n, F &&fn)
+    {
+        if (GGML_GEMMINI_TYPE == CPU) {
+            parallel_for(ctx, n, 1, [&](size_t p0, size_t p1) {
+                for (size_t p = p0; p < p1; p++)
+                    fn((int)p);
+            });
+            return;
+        }
+
+        ggml_gemmini_device_claim claim(ctx->device, n);
+        if (!claim) {
+            for (int p = 0; p < n; p++)
+                fn(p);
+            return;
+        }
+        run_devices(ctx, n, fn);
+    }
+
+    inline void matmul_call(size_t I, size_t J, size_t K,
+                            const int8_t *A, size_t sA, const int8_t *B, size_t sB,
+                            const int32_t *D, size_t sD, bool repeating, int8_t *C, size_t sC)
+    {
+        tiled_matmul_auto(I, J, K,
+                          (const elem_t *)A, (const elem_t *)B, D, (elem_t *)C,
+                          sA, sB, sD, sC,
+                          MVIN_SCALE_IDENTITY, MVIN_SCALE_IDENTITY, MVIN_SCALE_IDENTITY,
+                          NO_ACTIVATION,
+                          ACC_SCALE_IDENTITY, 0,
+                          repeating,
+                          false, false,
+                          false, false,
+                          0, GGML_GEMMINI_TYPE);
+    }
+
+    // host int8 matmul : C 행 [i0, i1) (tiled_matmul_auto 와 같은 결과)
+    //   B 의 행 (K x J) 을 j 방향으로 훑어 누적 : 안쪽 loop 가 연속 메모리라 SIMD 대상
+    void host_rows(size_t i0, size_t i1, size_t J, size_t K,
+                   const int8_t *A, size_t sA, const int8_t *B, size_t sB,
+                   const int32_t *D, size_t sD, bool repeating, int8_t *C, size_t sC)
+    {
+        std::vector<int32_t> acc(J);
+        for (size_t i = i0; i < i1; i++) {
+            if (D)
+                std::copy_n(D + (repeating ? 0 : i * sD), J, acc.begin());
+            else
+                std::fill(acc.begin(), acc.end(), 0);
+
+            for (size_t k = 0; k < K; k++) {
+                const int32_t a = A[i * sA + k];
+                if (a == 0)
+                    continue;
+                const int8_t *b = B + k * sB;
+                for (size_t j = 0; j < J; j++)
+                    acc[j] += a * b[j];
+            }
+            for (size_t j = 0; j < J; j++)
+                C[i * sC + j] = static_cast<int8_t>(std::clamp<int32_t>(acc[j], -128, 127));
+        }
+    }
+
+    // tensor parallel : J (부족하면 I) 를 DIM 배수 조각으로 나눠 device 마다 한 조각
+    //   조각끼리 C 의 다른 영역에 쓰므로 합산 없음. 다른 device 가 사용 중이면 하지 않음
+    bool tensor_parallel(ggml_backend_gemmini_context *ctx, size_t I, size_t J, size_t K,
+                         const int8_t *A, size_t sA, const int8_t *B, size_t sB,
+                         const int32_t *D, size_t sD, bool repeating, int8_t *C, size_t sC)
+    {
+        const size_t n_dev = tp_devices(ctx);
+        const size_t dim = (size_t)ctx->cost.dim;
+        if (n_dev < 2 || (double)I * J * K < GGML_GEMMINI_TP_MIN_MACS)
+            return false;
+
+        const bool by_j = J >= n_dev * dim;
+        if (!by_j && I < n_dev * dim)
+            return false;
+
+        const size_t len = align_up(((by_j ? J : I) + n_dev - 1) / n_dev, dim);
+        const int n_parts = (int)(((by_j ? J : I) + len - 1) / len);
+        ggml_gemmini_device_claim claim(ctx->device, n_parts);
+        if (!claim)
+            return false;
+
+        DBG("[Gemmini] tensor parallel: I=%zu J=%zu K=%zu by %s x %d\n", I, J, K, by_j ? "J" : "I", n_parts);
+
+        run_devices(ctx, n_parts, [&](int p) {
+            const size_t o = p * len;
+            if (by_j) {
+                matmul_call(I, std::min(len, J - o), K, A, sA, B + o, sB,
+                            D ? D + o : nullptr, sD, repeating, C + o, sC);
+            } else {
+                matmul_call(std::min(len, I - o), J, K, A + o * sA, sA, B, sB,
+                            D ? D + (repeating ? 0 : o * sD) : nullptr, sD, repeating, C + o * sC, sC);
+            }
+        });
+        return true;
+    }
+
+    // 가속기가 돌 동안 놀고 있는 host thread (n_threads - 1 개) 에 I 의 뒤쪽 행을 맡김
+    //   비율은 ctx->cost 의 실측 처리량으로 정해 두 쪽이 함께 끝나도록 하고, 끝나면 다시 보정
+    bool coexec(ggml_backend_gemmini_context *ctx, size_t I, size_t J, size_t K,
+                const int8_t *A, size_t sA, const int8_t *B, size_t sB,
+                const int32_t *D, size_t sD, bool repeating, int8_t *C, size_t sC)
+    {
+        const int host_threads = ctx->n_threads - 1;
+        const size_t dim = (size_t)ctx->cost.dim;
+        if (GGML_GEMMINI_TYPE == CPU || host_threads < 1 || I < 2 * dim ||
+            (double)I * J * K < GGML_GEMMINI_COEXEC_MIN_MACS)
+            return false;
+
+        // 가속기 몫은 DIM 배수로 (padding 낭비 방지)
+        const size_t I_host0 = (size_t)(ctx->cost.host_share(host_threads) * I);
+        const size_t I_acc = std::min(I, align_up(I - I_host0, dim));
+        const size_t I_host = I - I_acc;
+        if (I_host == 0)
+            return false;
+
+        DBG("[Gemmini] co-exec: I=%zu (gemmini %zu / host %zu x %d threads)\n", I, I_acc, I_host, host_threads);
+
+        const auto t0 = clock_type::now();
+        const size_t chunk = (I_host + host_threads - 1) / host_threads;
+        std::vector<std::future<clock_type::time_point>> workers;
+        for (size_t r0 = I_acc; r0 < I; r0 += chunk) {
+            const size_t r1 = std::min(I, r0 + chunk);
+            workers.push_back(std::async(std::launch::async, [=]() {
+                ggml_gemmini_unpin_thread(); // graph thread 의 hart 에서 벗어나 다른 core 로
+                host_rows(r0, r1, J, K, A, sA, B, sB, D, sD, repeating, C, sC);
+                return clock_type::now();
+            }));
+        }
+
+        matmul_call(I_acc, J, K, A, sA, B, sB, D, sD, repeating, C, sC);
+        const auto t_acc = clock_type::now();
+
+        auto t_host = t0;
+        for (auto &w : workers)
+            t_host = std::max(t_host, w.get());
+
+        const std::chrono::duration<double> acc_sec = t_acc - t0, host_sec = t_host - t0;
+        ctx->cost.calibrate((double)I_acc * J * K, acc_sec.count(), (double)I_host * J * K, host_threads, host_sec.count());
+        return true;
+    }
+}
+
+int ggml_backend_gemmini_split_k_parts(const ggml_backend_gemmini_context *ctx, size_t I, size_t J, size_t K)
+{
+    const int workers = split_workers(ctx);
+    if (workers < 2 || K < GGML_GEMMINI_SPLIT_K_MIN_RATIO * std::max(I, J))
+        return 1;
+
+    // 조각마다 K 가 DIM 이상 남는 범위에서 cost 가 가장 작은 조각 수
+    const ggml_gemmini_cost_model &cm = ctx->cost;
+    const int max_parts = std::min<int>(workers, (int)(K / (size_t)cm.dim));
+
+    int best = 1;
+    double best_cost = cm.matmul(I, J, K);
+    for (int n = 2; n <= max_parts; n++) {
+        const double c = cm.split_k(I, J, K, n);
+        if (c < best_cost) {
+            best = n;
+            best_cost = c;
+        }
+    }
+    return best;
+}
+
+void ggml_backend_gemmini_tiled_matmul(ggml_backend_gemmini_context *ctx,
+                                       size_t I, size_t J, size_t K,
+                                       const int8_t *A, size_t sA,
+                                       const int8_t *B, size_t sB,
+                                       const int32_t *D, size_t sD, bool repeating,
+                                       int8_t *C, size_t sC)
+{
+    // 자기 device 는 이 matmul 동안만 잡음 (tensor parallel / split-K 는 그 위에서 다른 device 를 claim)
+    std::lock_guard<std::mutex> own(ggml_gemmini_device_mutex(ctx->device));
+
+    const int n_parts = ggml_backend_gemmini_split_k_parts(ctx, I, J, K);
+
+    if (n_parts == 1) {
+        if (!tensor_parallel(ctx, I, J, K, A, sA, B, sB, D, sD, repeating, C, sC) &&
+            !coexec(ctx, I, J, K, A, sA, B, sB, D, sD, repeating, C, sC))
+            matmul_call(I, J, K, A, sA, B, sB, D, sD, repeating, C, sC);
+        return;
+    }
+
+    DBG("[Gemmini] split-K: I=%zu J=%zu K=%zu parts=%d\n", I, J, K, n_parts);
+
+    // (1) K 를 DIM 배수 조각으로 나눠 조각마다 int32 부분합
+    const size_t dim = (size_t)ctx->cost.dim;
+    const size_t k_part = align_up((K + n_parts - 1) / n_parts, dim);
+
+    std::vector<ggml_gemmini_tensor<int32_t>> parts;
+    parts.reserve(n_parts);
+    for (int p = 0; p < n_parts; p++)
+        parts.emplace_back(ctx->tmp_ctx, "split_k", I, J);
+    const size_t sP = parts[0].get_stride();
+
+    run_workers(ctx, n_parts, [&](int p) {
+        const size_t k0 = p * k_part;
+        if (k0 >= K)
+            return;
+        tiled_matmul_auto(I, J, std::min(k_part, K - k0),
+                          (const elem_t *)(A + k0), (const elem_t *)(B + k0 * sB), NULL,
+                          (acc_t *)parts[p].get(),
+                          sA, sB, 0, sP,
+                          MVIN_SCALE_IDENTITY, MVIN_SCALE_IDENTITY, MVIN_SCALE_IDENTITY,
+                          NO_ACTIVATION,
+                          ACC_SCALE_IDENTITY, 0,
+                          false,
+                          false, false,
+                          true, false, // full_C : int32 그대로
+                          0, GGML_GEMMINI_TYPE);
+    });
+
+    // (2) 부분합 + D 를 행 단위로 합산 후 int8 포화 (한 번에 끝낸 matmul 과 같은 결과)
+    parallel_for(ctx, I, 1, [&](size_t i0, size_t i1) {
+        std::vector<int32_t> acc(J);
+        for (size_t i = i0; i < i1; i++) {
+            if (D)
+                std::copy_n(D + (repeating ? 0 : i * sD), J, acc.begin());
+            else
+                std::fill(acc.begin(), acc.end(), 0);
+
+            for (int p = 0; p < n_parts; p++) {
+                const int32_t *P = static_cast<const int32_t *>(parts[p].get()) + i * sP;
+                for (size_t j = 0; j < J; j++)
+                    acc[j] += P[j];
+            }
+            for (size_t j = 0; j < J; j++)
+                C[i * sC + j] = static_cast<int8_t>(std::clamp<int32_t>(acc[j], -128, 127));
+        }
+    });
+}
@@ -0,0 +1,21 @@
+// ggml-gemmini-split.h
+#ifndef __GGML_GEMMINI_SPLIT_H__
+#define __GGML_GEMMINI_SPLIT_H__
+
+#include "ggml.h"
+#include "ggml-gemmini-util.h"
+
+// C (I x J int8) = sat8(A (I x K) * B (K x J) + D) : tiled_matmul_auto 와 같은 인자 / 결과
+//   K 가 I x J 에 비해 깊으면 cost model 에 따라 split-K 로 여러 worker 에 나눠 실행
+//   큰 matmul 은 I 를 가속기와 host thread pool 이 나눠 동시에 실행 (비율은 실측으로 보정)
+void ggml_backend_gemmini_tiled_matmul(ggml_backend_gemmini_context *ctx,
+                                       size_t I, size_t J, size_t K,
+                                       const int8_t *A, size_t sA,
+                                       const int8_t *B, size_t sB,
+                                       const int32_t *D, size_t sD, bool repeating,
+                                       int8_t *C, size_t sC);
+
+// split-K 조각 수 (1 이면 나누지 않음)
+int ggml_backend_gemmini_split_k_parts(const ggml_backend_gemmini_context *ctx, size_t I, size_t J, size_t K);
+
+#endif // __GGML_GEMMINI_SPLIT_H__
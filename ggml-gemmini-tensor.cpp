@@ -3,6 +3,10 @@
 
 #include "ggml-gemmini-tensor.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 namespace zerogod
 {
     template <typename T>
@@ -27,44 +31,86 @@ namespace zerogod
               ggml 네이티브: ne[0] = columns(X), ne[1] = rows(Y) */
         const int src_cols = transpose ? src->ne[1] : src->ne[0];
         const int src_rows = transpose ? src->ne[0] : src->ne[1];
-        ggml_type type = ggml_type_of<T>();
 
-        /* 2. _____16-byte row-stride 정렬을 위한 colum 패딩_____ */
-        const size_t elem_size = sizeof(T);
-        const size_t align_elems = GEMMINI_ALIGN / elem_size;
-        const int padded_cols = align_up(src_cols, align_elems);
+        /* 2-4. ____________tensor 생성 & buffer 할당____________ */
+        alloc_buffer(ctx, src->name, suffix, src_cols, src_rows);
 
-        /* 3. ___________________tensor 생성___________________ */
-        tensor_ = ggml_new_tensor_2d(ctx, type, padded_cols, src_rows);
-        snprintf(tensor_->name, sizeof(tensor_->name), "%s%s", src->name, suffix);
+        /* 5. _______________casting & 0-fill _________________ */
+        if (!acc)
+            ggml_gemmini_cast(src, transpose);
+        else
+            std::memset(data_, 0, buf_bytes_);
 
-        this->rows_ = tensor_->ne[1];
-        this->cols_ = tensor_->ne[0];
+        /* 6. _________________stride 업데이트__________________ */
+        update_stride();
+    }
 
-        /* 4. __________________buffer 할당____________________ */
-        const size_t row_bytes = align_up(this.cols_ * elem_size, GEMMINI_ALIGN);
-        buf_bytes_ = row_bytes * src_rows;
+    // x * scale 을 가장 가까운 정수로 반올림 후 T 범위로 포화
+    template <typename T>
+    static inline T quantize(float x, float scale)
+    {
+        const double y = std::nearbyint((double)x * scale);
+        return static_cast<T>(std::clamp<double>(y, std::numeric_limits<T>::min(), std::numeric_limits<T>::max()));
+    }
 
-        if (buf_bytes_ == 0)
-            buf_bytes_ = GEMMINI_ALIGN; // 최소 16 B 확보
+    // broadcast 생성자 : src 를 like 의 shape 으로 repeat 하여 양자화
+    // like 의 ne[1..3] 을 행으로 펼쳐 (ggml_nrows(like) x like->ne[0]) 2D 버퍼를 만든다
+    template <typename T>
+    ggml_gemmini_tensor<T>::ggml_gemmini_tensor(ggml_context *ctx,
+                                                const ggml_tensor *src,
+                                                const ggml_tensor *like,
+                                                const char *suffix,
+                                                float scale)
+    {
+        DBG("\ngenerate broadcast ggml_gemmini_tensor from: %s -> %s\n", src->name, like->name);
+        GGML_ASSERT(src->type == GGML_TYPE_F32 && "ggml_gemmini_tensor: broadcast supports F32 only");
+        GGML_ASSERT(ggml_can_repeat(src, like));
 
-        this->data_ = std::aligned_alloc(GEMMINI_ALIGN, buf_bytes_); // buffer을 16B 경계에 할당
-        GGML_ASSERT(this.data_ != nullptr);
+        alloc_buffer(ctx, src->name, suffix, like->ne[0], ggml_nrows(like));
 
-        tensor_->data = this.data_;
-        tensor_->nb[0] = elem_size;
-        tensor_->nb[1] = row_bytes;
-        stride_ = row_bytes / elem_size;
+        const uint8_t *src_base = static_cast<const uint8_t *>(src->data);
+        uint8_t *dst_row = static_cast<uint8_t *>(this->data_);
+        const size_t dst_row_bytes = stride_ * sizeof(T);
+        const int64_t cols = like->ne[0];
 
-        DBG("\ngenerated tensor: type=%s, cols=%d, rows=%d, buf_bytes=%zu\n", ggml_type_name(type), tensor_->ne[0], tensor_->ne[1], buf_bytes_);
+        for (size_t r = 0; r < rows_; ++r)
+        {
+            // dst 행 r -> like 좌표 (i1, i2, i3) -> src 좌표 (repeat)
+            const int64_t i1 = r % like->ne[1];
+            const int64_t i2 = (r / like->ne[1]) % like->ne[2];
+            const int64_t i3 = r / (like->ne[1] * like->ne[2]);
 
-        /* 5. _______________casting & 0-fill _________________ */
-        if (!acc)
-            ggml_gemmini_cast(src, transpose);
-        else
-            std::memset(data_, 0, buf_bytes_);
+            const uint8_t *src_row = src_base + (i1 % src->ne[1]) * src->nb[1]
+                                              + (i2 % src->ne[2]) * src->nb[2]
+                                              + (i3 % src->ne[3]) * src->nb[3];
+            T *dst_elem = reinterpret_cast<T *>(dst_row);
+
+            if (src->ne[0] == cols)
+                for (int64_t c = 0; c < cols; ++c)
+                    dst_elem[c] = quantize<T>(*reinterpret_cast<const float *>(src_row + c * src->nb[0]), scale);
+            else
+                for (int64_t c = 0; c < cols; ++c)
+                    dst_elem[c] = quantize<T>(*reinterpret_cast<const float *>(src_row + (c % src->ne[0]) * src->nb[0]), scale);
+
+            // 0-fill
+            if ((size_t)cols < this->cols_)
+                std::memset(dst_elem + cols, 0, (this->cols_ - cols) * sizeof(T));
+
+            dst_row += dst_row_bytes;
+        }
 
-        /* 6. _________________stride 업데이트__________________ */
+        update_stride();
+    }
+
+    // 빈 생성자 : rows x cols 의 0-fill 버퍼 (repacking 등 직접 채울 때 사용)
+    template <typename T>
+    ggml_gemmini_tensor<T>::ggml_gemmini_tensor(ggml_context *ctx,
+                                                const char *name,
+                                                size_t rows,
+                                                size_t cols)
+    {
+        alloc_buffer(ctx, name, "", cols, rows);
+        std::memset(data_, 0, buf_bytes_);
         update_stride();
     }
 
@@ -118,6 +164,74 @@ namespace zerogod
         return *this;
     }
 
+    template <typename T>
+    void ggml_gemmini_tensor<T>::alloc_buffer(ggml_context *ctx,
+                                              const char *name,
+                                              const char *suffix,
+                                              int src_cols,
+                                              int src_rows)
+    {
+        ggml_type type = ggml_type_of<T>();
+
+        /* _____16-byte row-stride 정렬을 위한 colum 패딩_____ */
+        const size_t elem_size = sizeof(T);
+        const size_t align_elems = GEMMINI_ALIGN / elem_size;
+        const int padded_cols = align_up(src_cols, align_elems);
+
+        /* ___________________tensor 생성___________________ */
+        // ctx 가 없으면 (weight cache) ggml 헤더 없이 버퍼만
+        if (ctx) {
+            tensor_ = ggml_new_tensor_2d(ctx, type, padded_cols, src_rows);
+            snprintf(tensor_->name, sizeof(tensor_->name), "%s%s", name, suffix);
+        }
+
+        this->rows_ = src_rows;
+        this->cols_ = padded_cols;
+
+        /* __________________buffer 할당____________________ */
+        const size_t row_bytes = align_up(this->cols_ * elem_size, GEMMINI_ALIGN);
+        buf_bytes_ = row_bytes * src_rows;
+
+        if (buf_bytes_ == 0)
+            buf_bytes_ = GEMMINI_ALIGN; // 최소 16 B 확보
+
+        this->data_ = std::aligned_alloc(GEMMINI_ALIGN, buf_bytes_); // buffer을 16B 경계에 할당
+        GGML_ASSERT(this->data_ != nullptr);
+
+        if (tensor_) {
+            tensor_->data = this->data_;
+            tensor_->nb[0] = elem_size;
+            tensor_->nb[1] = row_bytes;
+        }
+        stride_ = row_bytes / elem_size;
+
+        DBG("\ngenerated tensor: type=%s, cols=%zu, rows=%zu, buf_bytes=%zu\n", ggml_type_name(type), cols_, rows_, buf_bytes_);
+    }
+
+    // Gemmini 결과(int8/int32) -> FP32 dst 복사 (dst 의 ne[1..3] 을 행으로 펼쳐서 기록)
+    template <typename T>
+    void ggml_gemmini_tensor<T>::store(ggml_tensor *dst, float scale) const
+    {
+        GGML_ASSERT(dst->type == GGML_TYPE_F32 && "ggml_gemmini_tensor::store: dst must be F32");
+
+        const size_t rows = std::min<size_t>(ggml_nrows(dst), rows_);
+        const int64_t cols = std::min<int64_t>(dst->ne[0], cols_);
+        uint8_t *dst_base = static_cast<uint8_t *>(dst->data);
+
+        for (size_t r = 0; r < rows; ++r)
+        {
+            const int64_t i1 = r % dst->ne[1];
+            const int64_t i2 = (r / dst->ne[1]) % dst->ne[2];
+            const int64_t i3 = r / (dst->ne[1] * dst->ne[2]);
+
+            const T *src_elem = static_cast<const T *>(data_) + r * stride_;
+            uint8_t *dst_row = dst_base + i1 * dst->nb[1] + i2 * dst->nb[2] + i3 * dst->nb[3];
+
+            for (int64_t c = 0; c < cols; ++c)
+                *reinterpret_cast<float *>(dst_row + c * dst->nb[0]) = static_cast<float>(src_elem[c]) * scale;
+        }
+    }
+
     template <typename T>
     void ggml_gemmini_tensor<T>::ggml_gemmini_cast(const ggml_tensor *src,
                                                    bool transpose) const
@@ -131,7 +245,7 @@ namespace zerogod
 
         /* _____________________2. dst 정보______________________*/
         uint8_t *dst_row = static_cast<uint8_t *>(this->data_);
-        const size_t dst_row_bytes = tensor_->nb[1]; // 16B align된 값
+        const size_t dst_row_bytes = stride_ * sizeof(T); // 16B align된 값
         const size_t elem_size = static_cast<size_t>(ggml_type_size(ggml_type_of<T>()));
 
         /* ___________________3. 원본 타입별 분기__________________*/
@@ -161,7 +275,7 @@ namespace zerogod
 
                 // 0-fill
                 if (src_cols < this->cols_)
-                    std::memset(dst_elem + src_cols, 0, (this.cols_ - src_cols) * elem_size);
+                    std::memset(dst_elem + src_cols, 0, (this->cols_ - src_cols) * elem_size);
 
                 dst_row += dst_row_bytes;
             }
@@ -184,10 +298,57 @@ namespace zerogod
     template <typename T>
     void ggml_gemmini_tensor<T>::update_stride()
     {
+        if (!tensor_)
+            return;
         for (int d = 2; d < GGML_MAX_DIMS; ++d)
             tensor_->nb[d] = tensor_->nb[d - 1] * tensor_->ne[d - 1];
     }
 
+    // ______________________weight cache______________________
+    ggml_gemmini_weight_cache::ggml_gemmini_weight_cache(size_t max_bytes) : max_bytes_(max_bytes) {}
+
+    void ggml_gemmini_weight_cache::begin_graph()
+    {
+        epoch_++;
+        evict(0);
+    }
+
+    void ggml_gemmini_weight_cache::evict(size_t incoming)
+    {
+        // lru_ 뒤쪽이 가장 오래 안 쓴 항목. 이번 graph 에서 쓴 항목은 참조가 살아 있을 수 있으므로 남김
+        while (!lru_.empty() && bytes_ + incoming > max_bytes_) {
+            auto it = entries_.find(*lru_.back());
+            if (it->second.used == epoch_)
+                break;
+            DBG("[Gemmini] weight cache evict: layout=%d %zu bytes\n", it->first.layout, it->second.t.get_bytes());
+            bytes_ -= it->second.t.get_bytes();
+            lru_.pop_back();
+            entries_.erase(it);
+        }
+    }
+
+    bool ggml_gemmini_weight_cache::cacheable(const ggml_tensor *w)
+    {
+        return w->buffer != nullptr &&
+               ggml_backend_buffer_get_usage(w->buffer) == GGML_BACKEND_BUFFER_USAGE_WEIGHTS;
+    }
+
+    // ______________________staging cache______________________
+    void ggml_gemmini_staging_cache::plan(const ggml_tensor *t, ggml_gemmini_stage stage, int node_idx)
+    {
+        entry &e = entries_[key_t{t, t->data, stage}];
+        e.n_uses++;
+        e.last = std::max(e.last, node_idx);
+    }
+
+    void ggml_gemmini_staging_cache::release(int node_idx)
+    {
+        auto [first, last] = staged_.equal_range(node_idx);
+        for (auto it = first; it != last; ++it)
+            it->second->staged.reset();
+        staged_.erase(first, last);
+    }
+
     // explicit instantiation : 지원 타입 한정
     template class ggml_gemmini_tensor<int8_t>;
     template class ggml_gemmini_tensor<int32_t>;
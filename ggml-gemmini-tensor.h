@@ -7,10 +7,21 @@
 #include <type_traits>
 #include <cstdlib>
 #include <cstring>
+#include <list>
+#include <map>
+#include <tuple>
+#include <optional>
+#include <utility>
+#include <vector>
 
 #include "ggml.h"
 #include "ggml-gemmini-util.h"
 
+// weight cache 의 총 크기 상한 (MiB)
+#ifndef GGML_GEMMINI_WEIGHT_CACHE_MB
+#define GGML_GEMMINI_WEIGHT_CACHE_MB 1024
+#endif
+
 namespace zerogod
 {
     template <typename T>
@@ -26,6 +37,20 @@ namespace zerogod
                             bool acc = false,
                             bool transpose = false);
 
+        // src 를 like 의 shape 으로 broadcast (ggml_can_repeat 규칙)
+        //   값은 src * scale 을 반올림해 T 범위로 포화
+        ggml_gemmini_tensor(ggml_context *ctx,
+                            const ggml_tensor *src,
+                            const ggml_tensor *like,
+                            const char *suffix,
+                            float scale = 1.0f);
+
+        // rows x cols 의 0-fill 버퍼 (직접 repacking 할 때 사용)
+        ggml_gemmini_tensor(ggml_context *ctx,
+                            const char *name,
+                            size_t rows,
+                            size_t cols);
+
         ~ggml_gemmini_tensor();
 
         // 이동 전용 구현
@@ -46,7 +71,15 @@ namespace zerogod
         // stride 접근
         size_t get_stride() const noexcept { return stride_; }
 
+        // 할당된 버퍼 크기 (byte)
+        size_t get_bytes() const noexcept { return buf_bytes_; }
+
+        // 결과를 FP32 ggml 텐서로 write-back (값 x scale)
+        void store(ggml_tensor *dst, float scale = 1.0f) const;
+
     private:
+        void alloc_buffer(ggml_context *ctx, const char *name, const char *suffix,
+                          int src_cols, int src_rows);                   // tensor 생성 & buffer 할당
         void ggml_gemmini_cast(const ggml_tensor *src, bool transpose) const; // data casting
         void update_stride();                                             // stride 재계산
         void free_buffer();
@@ -62,6 +95,180 @@ namespace zerogod
     // explicit instantiation : 지원 타입 한정
     extern template class ggml_gemmini_tensor<int8_t>;
     extern template class ggml_gemmini_tensor<int32_t>;
+
+    // weight 를 Gemmini layout 으로 한 번만 변환해 두는 cache (WEIGHTS 용도의 buffer 에 있는 텐서만)
+    // 총 크기가 GGML_GEMMINI_WEIGHT_CACHE_MB 를 넘으면 graph 경계에서 오래 안 쓴 항목부터 해제
+    enum ggml_gemmini_layout
+    {
+        GEMMINI_LAYOUT_CONV_HWIO = 0, // conv weight : [KH][KW][IC] x OC
+        GEMMINI_LAYOUT_CONV_DW,       // depthwise weight : [C][KH][KW]
+        GEMMINI_LAYOUT_DECONV_HWIO,   // transposed conv weight : [KH][KW][IC] x OC (wrot180 전)
+        GEMMINI_LAYOUT_DECONV_1D,     // 1D transposed conv weight : [K][IC] x OC
+        GEMMINI_LAYOUT_CONV_1D,       // 1D conv weight : [K][IC] x OC
+        GEMMINI_LAYOUT_FFN_GATE_UP,   // gated FFN weight : K x [gate | up]
+        GEMMINI_LAYOUT_MUL_MAT_CONCAT,// sibling MUL_MAT weight : K x [w0 | w1 | ...]
+        GEMMINI_LAYOUT_LM_HEAD,       // output weight : K x n_vocab (chunk 단위로 열 offset 접근)
+        GEMMINI_LAYOUT_MOE_EXPERT,    // MUL_MAT_ID expert weight : K x M (slice = expert 번호)
+        GEMMINI_LAYOUT_MUL_MAT,       // 일반 MUL_MAT weight : K x M (Gemmini matmul / host GEMV 공용)
+    };
+
+    class ggml_gemmini_weight_cache
+    {
+    public:
+        explicit ggml_gemmini_weight_cache(size_t max_bytes = (size_t)GGML_GEMMINI_WEIGHT_CACHE_MB << 20);
+
+        ggml_gemmini_weight_cache(const ggml_gemmini_weight_cache &) = delete;
+        ggml_gemmini_weight_cache &operator=(const ggml_gemmini_weight_cache &) = delete;
+
+        // w 가 weight buffer 에 있어 cache 해도 안전한지
+        static bool cacheable(const ggml_tensor *w);
+
+        // graph 시작 : 이전 graph 까지만 쓴 항목을 오래된 순으로 budget 이하가 될 때까지 해제
+        //   (get 이 돌려준 참조는 그 graph 안에서만 유효)
+        void begin_graph();
+
+        // (w, layout) 에 해당하는 변환 결과, 없으면 make(nullptr) 로 생성 후 보관
+        template <typename F>
+        const ggml_gemmini_tensor<int8_t> &get(const ggml_tensor *w, ggml_gemmini_layout layout, F &&make)
+        {
+            return get(w, layout, 0, make);
+        }
+
+        // w 의 일부 (slice, 예: MoE expert 번호) 만 변환해 따로 보관할 때
+        template <typename F>
+        const ggml_gemmini_tensor<int8_t> &get(const ggml_tensor *w, ggml_gemmini_layout layout, int64_t slice, F &&make)
+        {
+            return find_or_make(key_t{layout, slice, {{w, w->data}}}, make);
+        }
+
+        // 여러 weight 를 이어 붙인 변환 결과 : 순서를 포함한 weight 목록 전체가 key
+        template <typename F>
+        const ggml_gemmini_tensor<int8_t> &get(const std::vector<const ggml_tensor *> &ws, ggml_gemmini_layout layout, F &&make)
+        {
+            key_t key{layout, 0, {}};
+            for (const ggml_tensor *w : ws)
+                key.ws.emplace_back(w, w->data);
+            return find_or_make(std::move(key), make);
+        }
+
+        // cache 가능하면 cache 에서, 아니면 tmp_ctx 에 local 로 매번 생성
+        template <typename F>
+        const ggml_gemmini_tensor<int8_t> &stage(ggml_context *tmp_ctx,
+                                                 const ggml_tensor *w,
+                                                 ggml_gemmini_layout layout,
+                                                 std::optional<ggml_gemmini_tensor<int8_t>> &local,
+                                                 F &&make)
+        {
+            if (cacheable(w))
+                return get(w, layout, make);
+            local.emplace(make(tmp_ctx));
+            return *local;
+        }
+
+    private:
+        struct key_t
+        {
+            int layout;
+            int64_t slice;
+            std::vector<std::pair<const ggml_tensor *, const void *>> ws;
+
+            bool operator<(const key_t &o) const { return std::tie(layout, slice, ws) < std::tie(o.layout, o.slice, o.ws); }
+        };
+
+        struct entry
+        {
+            ggml_gemmini_tensor<int8_t> t;
+            uint64_t used;                        // 마지막으로 쓴 graph (epoch_)
+            std::list<const key_t *>::iterator lru;
+        };
+
+        // 항목은 ggml context 없이 각자 버퍼를 가짐 (항목 수 제한 없음)
+        template <typename F>
+        const ggml_gemmini_tensor<int8_t> &find_or_make(key_t &&key, F &&make)
+        {
+            auto it = entries_.find(key);
+            if (it != entries_.end()) {
+                it->second.used = epoch_;
+                lru_.splice(lru_.begin(), lru_, it->second.lru);
+                return it->second.t;
+            }
+
+            ggml_gemmini_tensor<int8_t> t = make(nullptr);
+            evict(t.get_bytes());
+            bytes_ += t.get_bytes();
+            it = entries_.emplace(std::move(key), entry{std::move(t), epoch_, {}}).first;
+            lru_.push_front(&it->first);
+            it->second.lru = lru_.begin();
+            return it->second.t;
+        }
+
+        // bytes_ + incoming 이 budget 을 넘지 않도록 이전 graph 의 항목을 오래된 순으로 해제
+        void evict(size_t incoming);
+
+        std::map<key_t, entry> entries_;
+        std::list<const key_t *> lru_; // 앞쪽이 최근
+        size_t max_bytes_;
+        size_t bytes_ = 0;
+        uint64_t epoch_ = 0;
+    };
+
+    // activation 의 staging 방식 (MUL_MAT 의 A : 행 그대로, B : 전치)
+    enum ggml_gemmini_stage
+    {
+        GEMMINI_STAGE_ROWS = 0,
+        GEMMINI_STAGE_TRANSPOSED,
+    };
+
+    // graph 한 번 안에서 같은 텐서의 int8 staging 결과를 여러 consumer 가 공유하는 cache
+    // plan() 으로 등록된 사용이 2 번 이상인 텐서만 보관하고, 마지막 consumer 노드 실행 후 해제
+    class ggml_gemmini_staging_cache
+    {
+    public:
+        // node_idx 번째 노드가 (t, stage) 를 staging 한다고 등록 (graph 실행 전)
+        void plan(const ggml_tensor *t, ggml_gemmini_stage stage, int node_idx);
+
+        // 공유 대상이면 cache 에서, 아니면 local 에 매번 생성
+        template <typename F>
+        const ggml_gemmini_tensor<int8_t> &get(ggml_context *tmp_ctx,
+                                               const ggml_tensor *t,
+                                               ggml_gemmini_stage stage,
+                                               std::optional<ggml_gemmini_tensor<int8_t>> &local,
+                                               F &&make)
+        {
+            auto it = entries_.find(key_t{t, t->data, stage});
+            if (it == entries_.end() || it->second.n_uses < 2) {
+                local.emplace(make(tmp_ctx));
+                return *local;
+            }
+            entry &e = it->second;
+            if (!e.staged) {
+                e.staged.emplace(make(tmp_ctx));
+                staged_.emplace(e.last, &e); // plan 이 끝난 뒤라 last 는 더 바뀌지 않음
+            }
+            return *e.staged;
+        }
+
+        // node_idx 번째 노드 실행 후 : 그 노드가 마지막 consumer 인 staging 결과 해제
+        void release(int node_idx);
+
+        void clear()
+        {
+            staged_.clear();
+            entries_.clear();
+        }
+
+    private:
+        using key_t = std::tuple<const ggml_tensor *, const void *, int>;
+
+        struct entry
+        {
+            int n_uses = 0;
+            int last = -1; // 마지막 consumer 노드 index
+            std::optional<ggml_gemmini_tensor<int8_t>> staged;
+        };
+        std::map<key_t, entry> entries_;
+        std::multimap<int, entry *> staged_; // staging 된 항목만 last 로 색인 (release 가 전체를 훑지 않도록)
+    };
 }
 
 #endif // __GGML_GEMMINI_TENSOR_H__
\ No newline at end of file
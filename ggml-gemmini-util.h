@@ -1,4 +1,7 @@
 // ggml-gemmini-util.h
+#ifndef __GGML_GEMMINI_UTIL_H__
+#define __GGML_GEMMINI_UTIL_H__
+
 #ifndef DEBUG
 #define DEBUG 0
 #endif
@@ -8,15 +11,24 @@
 #include "ggml-backend-impl.h"
 
 #include <future>
+#include <thread>
 #include <vector>
 #include <map>
 #include <set>
 #include <cstring>
+#include <memory>
+#include <algorithm>
+#include <cmath>
 
 #ifndef PRINT_TILE
 #define PRINT_TILE 0
 #endif
 
+// Gemmini 실행 모드 (tiled_matmul_type_t : OS / WS / CPU)
+#ifndef GGML_GEMMINI_TYPE
+#define GGML_GEMMINI_TYPE CPU
+#endif
+
 #if DEBUG 
     #define DBG(fmt, ...) \
         fprintf(stderr, "[%s:%d] %s(): " fmt "\n", __FILE__, __LINE__, __func__, ##__VA_ARGS__)
@@ -25,15 +37,157 @@
 #endif
 
 
+// LM head : MUL_MAT 결과를 vocab chunk 단위로 훑으며 running top-k 만 남김
+//   sel 은 ARGMAX (k = 1) 또는 ggml_top_k 의 ARGSORT(DESC), logits 는 full logits 도 기록할지
+struct ggml_gemmini_lm_head
+{
+    ggml_tensor *sel = nullptr;
+    int k = 1;
+    bool logits = false;
+};
+
+namespace zerogod
+{
+    class ggml_gemmini_weight_cache;
+    class ggml_gemmini_staging_cache;
+    class ggml_gemmini_kv_cache;
+    class ggml_gemmini_batcher;
+    class ggml_gemmini_queue;
+
+    // host 작업용 thread 에서 호출 : hart 에 고정된 graph thread 로부터 물려받은 affinity 를
+    // process 원래 affinity 로 되돌림 (ggml-gemmini-device.cpp, thread 마다 한 번만 적용)
+    void ggml_gemmini_unpin_thread();
+}
+
+// gated FFN 패턴 : MUL(SILU(gate), up) 또는 GLU(SWIGLU, gate, up)
+//   gate / up 은 같은 src1 을 쓰는 MUL_MAT, silu 는 MUL 패턴일 때의 SILU 노드 (GLU 면 nullptr)
+struct ggml_gemmini_ffn_match
+{
+    ggml_tensor *gate = nullptr;
+    ggml_tensor *up = nullptr;
+    ggml_tensor *silu = nullptr;
+};
+
+// cost model 기본값 (cycle 단위 상대 비교용, SoC 에 맞게 빌드 시 조정)
+#ifndef GGML_GEMMINI_COST_DIM
+#define GGML_GEMMINI_COST_DIM 16            // gemmini_params.h 의 DIM
+#endif
+#ifndef GGML_GEMMINI_COST_DRAM_BPC
+#define GGML_GEMMINI_COST_DRAM_BPC 16.0     // 가속기 mvin / mvout byte / cycle
+#endif
+#ifndef GGML_GEMMINI_COST_HOST_BPC
+#define GGML_GEMMINI_COST_HOST_BPC 8.0      // host core 전체의 load byte / cycle
+#endif
+#ifndef GGML_GEMMINI_COST_HOST_MACS
+#define GGML_GEMMINI_COST_HOST_MACS 8.0     // host thread 하나의 int8 MAC / cycle (SIMD)
+#endif
+#ifndef GGML_GEMMINI_COST_HOST_CAST
+#define GGML_GEMMINI_COST_HOST_CAST 1.0     // host thread 하나의 f32 -> int8 변환 원소 / cycle
+#endif
+#ifndef GGML_GEMMINI_COST_CALL
+#define GGML_GEMMINI_COST_CALL 2000.0       // tiled_matmul_auto 호출 / config 고정 비용
+#endif
+#ifndef GGML_GEMMINI_COST_EMA
+#define GGML_GEMMINI_COST_EMA 0.25          // 실측 처리량 갱신 비율
+#endif
+
+// 실행 경로 선택용 cost model : 같은 작업을 두 경로로 돌렸을 때의 예상 cycle 비교에만 사용
+struct ggml_gemmini_cost_model
+{
+    double dim = GGML_GEMMINI_COST_DIM;
+    double dram_bpc = GGML_GEMMINI_COST_DRAM_BPC;
+    double host_bpc = GGML_GEMMINI_COST_HOST_BPC;
+    double host_macs = GGML_GEMMINI_COST_HOST_MACS;
+    double host_cast = GGML_GEMMINI_COST_HOST_CAST;
+    double call = GGML_GEMMINI_COST_CALL;
+
+    // co-execution 실측 처리량 (MAC / s, 0 이면 측정 전 : 위의 추정치로 비율 계산)
+    double acc_rate = 0.0;  // 가속기
+    double host_rate = 0.0; // host thread 하나
+
+    // Gemmini I x J x K matmul : DIM 단위 padding 을 포함한 systolic 시간과 DRAM 전송 시간 중 큰 쪽
+    double matmul(size_t I, size_t J, size_t K) const
+    {
+        const double pi = pad(I), pj = pad(J), pk = pad(K);
+        const double compute = pi * pj * pk / (dim * dim);
+        const double memory = (pk * pj + pi * pk + pi * pj) / dram_bpc;
+        return std::max(compute, memory) + call;
+    }
+
+    // split-K : K 를 n 조각으로 나눠 worker 가 동시에 int32 부분합, host 에서 합산 (부분합 읽기가 대부분)
+    double split_k(size_t I, size_t J, size_t K, int n) const
+    {
+        const double part = matmul(I, J, (K + n - 1) / n);
+        const double reduce = pad(I) * pad(J) * n * sizeof(int32_t) / host_bpc;
+        return part + reduce;
+    }
+
+    // host int8 GEMV (I 행) : weight J x K 를 한 번 읽는 대역폭과 MAC 중 큰 쪽
+    double host_gemv(size_t I, size_t J, size_t K, int n_threads) const
+    {
+        const double compute = (double)I * J * K / (host_macs * std::max(n_threads, 1));
+        const double memory = (double)J * K / host_bpc;
+        return std::max(compute, memory);
+    }
+
+    // host 에서 f32 / f16 원소 n 개를 int8 로 변환
+    double stage(size_t n, int n_threads) const
+    {
+        return (double)n / (host_cast * std::max(n_threads, 1));
+    }
+
+    // 가속기와 host thread host_threads 개가 동시에 끝나도록 host 에 줄 작업 비율
+    double host_share(int host_threads) const
+    {
+        const bool measured = acc_rate > 0.0 && host_rate > 0.0;
+        const double h = (measured ? host_rate : host_macs) * host_threads;
+        const double a = measured ? acc_rate : dim * dim;
+        return h / (h + a);
+    }
+
+    // co-execution 한 번의 실측 (가속기 / host 각각 처리한 MAC 수와 걸린 시간) 으로 처리량 갱신
+    void calibrate(double acc_work, double acc_sec, double host_work, int host_threads, double host_sec)
+    {
+        if (acc_sec <= 0.0 || host_sec <= 0.0 || host_threads <= 0)
+            return;
+        const double a = acc_work / acc_sec, h = host_work / host_sec / host_threads;
+        acc_rate = acc_rate > 0.0 ? acc_rate + GGML_GEMMINI_COST_EMA * (a - acc_rate) : a;
+        host_rate = host_rate > 0.0 ? host_rate + GGML_GEMMINI_COST_EMA * (h - host_rate) : h;
+    }
+
+    double pad(size_t n) const
+    {
+        return std::ceil(n / dim) * dim;
+    }
+};
+
 struct ggml_backend_gemmini_context
 {
     int n_threads = GGML_DEFAULT_N_THREADS;
+    int device = 0;                // ggml_gemmini_devices() index
+    int hart = -1;                 // graph 실행 thread 를 고정할 hart (-1 : 고정 안 함)
+    bool tensor_parallel = false;  // 큰 MUL_MAT 을 모든 device 에 나눠 실행
     std::unique_ptr<char[]> work_data;
     size_t work_size = 0;
-    std::map<ggml_tensor *, ggml_tensor *> bias_map;
+    std::map<ggml_tensor *, ggml_tensor *> bias_map;   // MUL_MAT -> D preload 로 더할 텐서 (bias / residual)
+    std::map<ggml_tensor *, ggml_tensor *> fused_out;  // MUL_MAT -> 결과를 대신 기록할 ADD 노드
+    std::set<ggml_tensor *> fused_nodes;               // MUL_MAT 에 흡수되어 건너뛸 노드
+    std::map<ggml_tensor *, ggml_tensor *> conv_map;   // MUL_MAT -> native conv 로 대체할 IM2COL 노드
+    std::map<ggml_tensor *, ggml_gemmini_ffn_match> ffn_map; // MUL / GLU -> gate / up MUL_MAT 쌍 (fused FFN)
+    std::map<ggml_tensor *, ggml_tensor *> rope_map;   // MUL_MAT -> writeback 에서 함께 처리할 ROPE 노드
+    std::map<ggml_tensor *, ggml_gemmini_lm_head> lm_head_map; // MUL_MAT -> top-k / argmax 를 epilogue 로 흡수
+    std::map<ggml_tensor *, std::vector<ggml_tensor *>> mm_groups; // 마지막 MUL_MAT -> 같은 src1 을 쓰는 MUL_MAT 묶음
     struct ggml_context *tmp_ctx = nullptr;
     void *arena = nullptr;
     bool tmp_ctx_initialized = false;
+    std::shared_ptr<zerogod::ggml_gemmini_weight_cache> weight_cache; // weight 변환 결과 (backend 수명)
+    std::shared_ptr<zerogod::ggml_gemmini_staging_cache> staging;     // activation staging 결과 (graph 수명)
+    std::shared_ptr<zerogod::ggml_gemmini_kv_cache> kv_cache;         // 등록된 KV cache 의 staging (backend 수명)
+    std::shared_ptr<zerogod::ggml_gemmini_batcher> batcher;           // graph 사이 MUL_MAT batching (backend 공유)
+    int batch_graph = -1;                                             // 실행 중인 graph 의 batcher id
+    std::set<const ggml_tensor *> batch_nodes;                        // batcher 로 보낼 MUL_MAT
+    ggml_gemmini_cost_model cost;                                     // 실행 경로 선택
+    std::shared_ptr<zerogod::ggml_gemmini_queue> queue;               // async 명령 queue (hart 고정 worker)
 
 #ifndef GGML_USE_OPENMP
     std::vector<std::future<void>> tasks;
@@ -48,6 +202,84 @@ namespace zerogod
     {
         return (val + align - 1) / align * align;
     }
+
+    // F32 / F16 텐서의 (i0, i1, i2, i3) 원소를 float 로 읽기
+    static inline float get_f32(const ggml_tensor *t, int64_t i0, int64_t i1 = 0, int64_t i2 = 0, int64_t i3 = 0)
+    {
+        const char *p = (const char *)t->data + i0 * t->nb[0] + i1 * t->nb[1] + i2 * t->nb[2] + i3 * t->nb[3];
+        switch (t->type) {
+        case GGML_TYPE_F32: return *(const float *)p;
+        case GGML_TYPE_F16: return ggml_fp16_to_fp32(*(const ggml_fp16_t *)p);
+        default:
+            GGML_ABORT("get_f32: unsupported type %s", ggml_type_name(t->type));
+        }
+    }
+
+    // view / no-op 노드는 원본 텐서를 그대로 가리킴
+    static inline bool is_view_op(const ggml_tensor *t)
+    {
+        switch (t->op) {
+        case GGML_OP_NONE:
+        case GGML_OP_RESHAPE:
+        case GGML_OP_VIEW:
+        case GGML_OP_PERMUTE:
+        case GGML_OP_TRANSPOSE:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    static inline const ggml_tensor *view_root(const ggml_tensor *t)
+    {
+        while (t->view_src)
+            t = t->view_src;
+        return t;
+    }
+
+    // [0, n) 구간을 backend thread pool 에 나눠서 fn(begin, end) 실행
+    // min_chunk 보다 작은 조각으로는 나누지 않는다 (CPU 모드 전용)
+    template <typename F>
+    static void parallel_for(ggml_backend_gemmini_context *ctx, size_t n, size_t min_chunk, F &&fn)
+    {
+        const size_t max_threads = min_chunk ? std::max<size_t>(1, n / min_chunk) : n;
+        const size_t n_threads = std::min<size_t>(std::max(ctx->n_threads, 1), max_threads);
+        if (n_threads <= 1) {
+            fn((size_t)0, n);
+            return;
+        }
+
+        const size_t chunk = (n + n_threads - 1) / n_threads;
+
+        // worker 는 호출 thread (Gemmini 명령을 보내는 hart 고정 thread) 의 affinity 를 물려받으므로 풀어서 실행
+#ifdef GGML_USE_OPENMP
+        const std::thread::id caller = std::this_thread::get_id();
+        #pragma omp parallel for num_threads(n_threads)
+        for (size_t t = 0; t < n_threads; t++) {
+            if (std::this_thread::get_id() != caller)
+                ggml_gemmini_unpin_thread();
+            const size_t begin = t * chunk;
+            const size_t end = std::min(n, begin + chunk);
+            if (begin < end)
+                fn(begin, end);
+        }
+#else
+        for (size_t t = 1; t < n_threads; t++) {
+            const size_t begin = t * chunk;
+            const size_t end = std::min(n, begin + chunk);
+            if (begin < end)
+                ctx->tasks.push_back(std::async(std::launch::async, [&fn, begin, end]() {
+                    ggml_gemmini_unpin_thread();
+                    fn(begin, end);
+                }));
+        }
+        fn((size_t)0, std::min(n, chunk));
+
+        for (auto &task : ctx->tasks)
+            task.get();
+        ctx->tasks.clear();
+#endif
+    }
     
     static void ggml_calc_tmp_ctx_size(ggml_cgraph *cgraph,
                                        ggml_backend_gemmini_context *ctx,
@@ -132,3 +364,4 @@ namespace zerogod
     }
 }
 
+#endif // __GGML_GEMMINI_UTIL_H__
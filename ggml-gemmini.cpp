@@ -1,84 +1,225 @@
 #define DEBUG 1
 
 #include "ggml-gemmini-tensor.h"
-#include "include/gemmini.h"
+#include "ggml-gemmini-conv.h"
+#include "ggml-gemmini-fused.h"
+#include "ggml-gemmini-kv.h"
+#include "ggml-gemmini-gemv.h"
+#include "ggml-gemmini-batch.h"
+#include "ggml-gemmini-split.h"
+#include "ggml-gemmini-device.h"
+#include "gemmini.h"
 #include <optional>
 
 using namespace zerogod;
 
 static void ggml_backend_gemmini_mul_mat(
                                          ggml_backend_gemmini_context *ctx,
-                                         struct ggml_tensor *dst, // FP32 output (I×J)
-                                         struct ggml_tensor *bias) // optional FP32 bias (->int32)
+                                         struct ggml_tensor *dst,  // MUL_MAT 노드
+                                         struct ggml_tensor *bias, // optional FP32 bias / residual (->int32, D preload)
+                                         struct ggml_tensor *out,  // FP32 결과를 기록할 텐서 (dst 또는 fusion 된 ADD)
+                                         const struct ggml_tensor *rope) // optional : writeback 에서 함께 적용할 ROPE
 {
-    // TODO: bias 처리
     DBG("[Gemmini] mul_mat call\n");
 
     // 0. 원본 FP32 입력 텐서
-    const auto *src0 = dst->src[0];         // A:  I × K
-    const auto *src1 = dst->src[1];         // B:  K × J (But transpose되어 메모리상 J x K)
+    //    ggml: dst(ne0 = M, ne1 = N) = src0(K x M)^T * src1(K x N), 메모리상 dst 는 N x M
+    //    -> C(N x M) = A(N x K) * B(K x M),  A = src1, B = src0^T
+    const auto *src0 = dst->src[0];         // weight     : ne0 = K, ne1 = M
+    const auto *src1 = dst->src[1];         // activation : ne0 = K, ne1 = N
 
     DBG("\ndst shape:\n ne = [%llu, %llu, %llu, %llu]\n", dst->ne[0], dst->ne[1], dst->ne[2], dst->ne[3]);
     DBG("\nsrc0 shape:\n ne = [%llu, %llu, %llu, %llu]\n", src0->ne[0], src0->ne[1], src0->ne[2], src0->ne[3]);
     DBG("\nsrc1 shape:\n ne = [%llu, %llu, %llu, %llu]\n", src1->ne[0], src1->ne[1], src1->ne[2], src1->ne[3]);
 
-    ggml_gemmini_tensor<int8_t> tA(ctx->tmp_ctx, src0, ".i8");
-    ggml_gemmini_tensor<int8_t> tB(ctx->tmp_ctx, src1, ".i8", false, true);
+    // 같은 텐서를 여러 MUL_MAT 이 쓰면 staging 결과를 공유 (graph_compute 에서 plan)
+    std::optional<ggml_gemmini_tensor<int8_t>> localA, localB;
+    const auto &tA = ctx->staging->get(ctx->tmp_ctx, src1, GEMMINI_STAGE_ROWS, localA, [&](ggml_context *c) {
+        return ggml_gemmini_tensor<int8_t>(c, src1, ".i8");
+    });
     ggml_gemmini_tensor<int8_t> tC(ctx->tmp_ctx, dst, ".i8", true);
     std::optional<ggml_gemmini_tensor<int32_t>> tD;
     if (bias)
         tD.emplace(ctx->tmp_ctx, bias, ".i32");
 
-    const size_t I = tC.get_rows(); // I = A.ne[1], K = A.ne[0]
-    const size_t J = tC.get_cols(); // K = B.ne[0], J = B.ne[1] (transpose)
-    const size_t K = tA.get_cols();
+    const size_t I = dst->ne[1];  // N
+    const size_t J = dst->ne[0];  // M
+    const size_t K = src0->ne[0]; // K (패딩은 Gemmini 가 처리)
     DBG("I=%zu, J=%zu, K=%zu\n", I, J, K);
 
     // stride
     const size_t sA = tA.get_stride();
-    const size_t sB = tB.get_stride();
     const size_t sC = tC.get_stride();
     GGML_ASSERT(sA % 16 == 0);
-    GGML_ASSERT(sB % 16 == 0);
     GGML_ASSERT(sC % 16 == 0);
 
-    // bias tensor
-    std::vector<int32_t> zero_bias(tC.get_cols(), 0); 
-
-    const int32_t *bias_data = tD ? static_cast<int32_t *>(tD->get()) : zero_bias.data();
+    // bias / residual tensor : 1 행이면 repeating bias, 아니면 I x J 전체를 D 로 preload
+    const void *bias_data = tD ? tD->get() : nullptr;
     const size_t sD = tD ? tD->get_stride() : 0;
-    const bool repeating = tD ? tD->get_rows() == 1 : true;
-
-    DBG("calling tiled_matmul_auto: ptrA=%p ptrB=%p ptrD=%p ptrC=%p\n",
-           (void*)tA.get(), (void*)tB.get(), (void*)bias_data, (void*)tC.get());
-
-    // 5. Gemmini 호출
-    tiled_matmul_auto(I, J, K,
-                      (elem_t*)tA.get(),
-                      (elem_t*)tB.get(),
-                      (void*)bias_data,
-                      (elem_t*)tC.get(),
-                      sA, sB, sD, sC,
-                      1.f, 1.f, 1.f,
-                      NO_ACTIVATION,
-                      1, 1,
-                      repeating,
-                      false,    // transpose_A
-                      false,    // transpose_B
-                      false, false,
-                      0, CPU);
-
-    /*
-    // 6. int32 -> float 결과 복사 (stride 사용)
-    float   *out_f = (float*)dst->data;
-    int32_t *acc32 = (int32_t*)tC->data;
-    const size_t row_stride  = stride_e_C;
-
-    for (size_t r = 0; r < I; ++r)
-        memcpy(out_f + r * J,
-               acc32 + r * row_stride,
-               J * sizeof(float));
-    */
+    const bool repeating = tD ? tD->get_rows() == 1 : false;
+
+    // 다른 sequence 의 graph 가 다음에 같은 weight 를 쓰면 token 축으로 묶어서 실행
+    // token 이 몇 개 안 되면 (decode) DIM padding 으로 배열 대부분이 놀게 되므로 host GEMV
+    if (ctx->batch_nodes.count(dst)) {
+        ctx->batcher->mul_mat(ctx, ctx->batch_graph, src0, {(const int8_t *)tA.get(), sA, I,
+                                          (const int32_t *)bias_data, sD, repeating,
+                                          (int8_t *)tC.get(), sC});
+    } else if (ggml_backend_gemmini_gemv_preferred(ctx, src0, I)) {
+        ggml_backend_gemmini_gemv(ctx, src0, (const int8_t *)tA.get(), sA, I,
+                                  (const int32_t *)bias_data, sD, repeating,
+                                  (int8_t *)tC.get(), sC);
+    } else {
+        // weight buffer 의 weight 는 GEMV 와 같은 cache 항목을 쓰고, 아니면 graph 안에서만 공유
+        auto make = [&](ggml_context *c) { return ggml_gemmini_tensor<int8_t>(c, src0, ".i8", false, true); };
+        const auto &tB = ggml_gemmini_weight_cache::cacheable(src0)
+            ? ctx->weight_cache->get(src0, GEMMINI_LAYOUT_MUL_MAT, make)
+            : ctx->staging->get(ctx->tmp_ctx, src0, GEMMINI_STAGE_TRANSPOSED, localB, make);
+        const size_t sB = tB.get_stride();
+        GGML_ASSERT(sB % 16 == 0);
+
+        DBG("calling tiled_matmul_auto: ptrA=%p ptrB=%p ptrD=%p ptrC=%p\n",
+               (void*)tA.get(), (void*)tB.get(), (void*)bias_data, (void*)tC.get());
+
+        // 5. Gemmini 호출 (deep & narrow 면 split-K)
+        ggml_backend_gemmini_tiled_matmul(ctx, I, J, K,
+                                          (const int8_t *)tA.get(), sA,
+                                          (const int8_t *)tB.get(), sB,
+                                          (const int32_t *)bias_data, sD, repeating,
+                                          (int8_t *)tC.get(), sC);
+    }
+
+    // 6. int8 -> float 결과 복사 (stride 사용), Q / K projection 이면 RoPE 까지
+    if (rope)
+        ggml_backend_gemmini_store_rows(ctx, (const int8_t *)tC.get(), sC, out, rope);
+    else
+        tC.store(out);
+}
+
+// F32 텐서의 최대 절대값 (행 단위로 thread pool 에 분배)
+static float ggml_backend_gemmini_max_abs(ggml_backend_gemmini_context *ctx, const ggml_tensor *t)
+{
+    const int64_t rows = ggml_nrows(t);
+    std::vector<float> part(rows, 0.0f);
+    parallel_for(ctx, rows, 16, [&](size_t r0, size_t r1) {
+        for (size_t r = r0; r < r1; r++) {
+            const int64_t i1 = r % t->ne[1], i2 = (r / t->ne[1]) % t->ne[2], i3 = r / (t->ne[1] * t->ne[2]);
+            const char *row = (const char *)t->data + i1 * t->nb[1] + i2 * t->nb[2] + i3 * t->nb[3];
+            float m = 0.0f;
+            for (int64_t c = 0; c < t->ne[0]; c++)
+                m = std::max(m, std::fabs(*(const float *)(row + c * t->nb[0])));
+            part[r] = m;
+        }
+    });
+    return rows ? *std::max_element(part.begin(), part.end()) : 0.0f;
+}
+
+// 일반 ADD (residual 등) : A + B -> C, src1 은 dst shape 으로 broadcast
+//   residual stream 은 int8 범위를 넘으므로 |A| + |B| 의 최대가 127 이 되는 scale 로 양자화 (반올림, 포화)
+//   하고, 결과를 같은 scale 로 복원
+static void ggml_backend_gemmini_add(ggml_backend_gemmini_context *ctx, struct ggml_tensor *dst)
+{
+    DBG("[Gemmini] add call\n");
+
+    const auto *src0 = dst->src[0];
+    const auto *src1 = dst->src[1];
+
+    const float range = ggml_backend_gemmini_max_abs(ctx, src0) + ggml_backend_gemmini_max_abs(ctx, src1);
+    const float scale = range > 0.0f ? 127.0f / range : 1.0f;
+
+    ggml_gemmini_tensor<int8_t> tA(ctx->tmp_ctx, src0, dst, ".i8", scale);
+    ggml_gemmini_tensor<int8_t> tB(ctx->tmp_ctx, src1, dst, ".i8", scale);
+    GGML_ASSERT(tA.get_stride() == tB.get_stride());
+
+    const size_t I = tA.get_rows();
+    const size_t J = dst->ne[0];
+
+    const size_t stride = tA.get_stride();
+    const elem_t *A = (const elem_t*)tA.get();
+    const elem_t *B = (const elem_t*)tB.get();
+    elem_t *C = (elem_t*)tA.get(); // element-wise 연산이므로 결과는 A 버퍼에 in-place 로 기록
+
+    if (GGML_GEMMINI_TYPE == CPU) {
+        // CPU 모드 : 행 단위로 thread pool 에 분배
+        parallel_for(ctx, I, DIM, [&](size_t i0, size_t i1) {
+            resadd_cpu(i1 - i0, J, stride,
+                       MVIN_SCALE_IDENTITY, MVIN_SCALE_IDENTITY, ACC_SCALE_IDENTITY,
+                       A + i0 * stride, B + i0 * stride, C + i0 * stride,
+                       false);
+        });
+    } else {
+        std::lock_guard<std::mutex> own(ggml_gemmini_device_mutex(ctx->device));
+        tiled_resadd_stride_auto(I, J,
+                                 MVIN_SCALE_IDENTITY, MVIN_SCALE_IDENTITY, ACC_SCALE_IDENTITY,
+                                 stride,
+                                 A, B, C,
+                                 false, // relu
+                                 GGML_GEMMINI_TYPE);
+    }
+
+    tA.store(dst, 1.0f / scale);
+}
+
+// ADD(MUL_MAT, x) 를 MUL_MAT 의 D preload 로 흡수할 수 있는지 검사
+//   - MUL_MAT 결과를 ADD 만 사용해야 하고
+//   - x 는 MUL_MAT 실행 전에 이미 계산되어 있어야 하며
+//   - x 는 bias(1 x M) 또는 residual(N x M) 형태의 2D 텐서여야 한다
+//   - 다른 backend 의 split 도 MUL_MAT 결과를 읽을 수 있으므로 (n_uses 는 이 split 안만 셈)
+//     ADD 가 MUL_MAT 자리에 in-place 로 할당된 경우만 : graph allocator 는 graph 전체에서
+//     ADD 가 유일한 consumer 일 때만 그렇게 배치함
+static bool ggml_backend_gemmini_can_fuse_add(const ggml_tensor *mm,
+                                              const ggml_tensor *x,
+                                              const ggml_tensor *add,
+                                              const std::map<const ggml_tensor *, int> &n_uses,
+                                              const std::map<const ggml_tensor *, int> &node_idx)
+{
+    if (mm->op != GGML_OP_MUL_MAT || (mm->flags & GGML_TENSOR_FLAG_OUTPUT) ||
+        !ggml_is_contiguous(mm->src[0]) || !ggml_is_contiguous(mm->src[1]))
+        return false;
+
+    auto it = n_uses.find(mm);
+    if (it == n_uses.end() || it->second != 1 || add->data != mm->data)
+        return false;
+
+    if (x->type != GGML_TYPE_F32 || add->ne[2] != 1 || add->ne[3] != 1 ||
+        x->ne[2] != 1 || x->ne[3] != 1 ||
+        x->ne[0] != add->ne[0] || (x->ne[1] != 1 && x->ne[1] != add->ne[1]))
+        return false;
+
+    const int mm_idx = node_idx.at(mm);
+    for (const ggml_tensor *t = x; t != nullptr; t = t->view_src) {
+        auto jt = node_idx.find(t);
+        if (jt != node_idx.end() && jt->second > mm_idx)
+            return false;
+    }
+    return true;
+}
+
+// KV view (attention score / context) 를 읽는 MUL_MAT : staging 을 graph 사이에 재사용
+//   epilogue fusion 이 없는 경우만
+static bool ggml_backend_gemmini_use_kv_mul_mat(const ggml_backend_gemmini_context *ctx, ggml_tensor *mm)
+{
+    return mm->src[0]->view_src != nullptr &&
+           !ctx->bias_map.count(mm) && !ctx->fused_out.count(mm) && !ctx->rope_map.count(mm) &&
+           !ctx->mm_groups.count(mm) && !ctx->lm_head_map.count(mm) &&
+           ggml_backend_gemmini_kv_mul_mat_supported(mm);
+}
+
+// IM2COL 결과가 MUL_MAT 하나에서만 쓰이면 두 노드를 native conv 하나로 대체
+static ggml_tensor *ggml_backend_gemmini_can_fuse_conv(const ggml_tensor *mm,
+                                                       const std::map<const ggml_tensor *, int> &n_uses)
+{
+    ggml_tensor *im2col = ggml_backend_gemmini_match_im2col_mul_mat(mm);
+    if (!im2col)
+        return nullptr;
+
+    for (const ggml_tensor *t = mm->src[0]; ; t = t->src[0]) {
+        auto it = n_uses.find(t);
+        if ((t->flags & GGML_TENSOR_FLAG_OUTPUT) || it == n_uses.end() || it->second != 1)
+            return nullptr;
+        if (t == im2col)
+            break;
+    }
+    return im2col;
 }
 
 static void ggml_backend_gemmini_out_prod(ggml_backend_gemmini_context *ctx, struct ggml_tensor *dst)
@@ -99,22 +240,192 @@ static const char *ggml_backend_gemmini_get_name(ggml_backend_t backend)
 static void ggml_backend_gemmini_free(ggml_backend_t backend)
 {
     ggml_backend_gemmini_context *ctx = (ggml_backend_gemmini_context *)backend->context;
+    ctx->queue.reset(); // 남은 명령 실행 후 worker 종료
+    if (ctx->tmp_ctx)
+        ggml_free(ctx->tmp_ctx);
     delete ctx;
     delete backend;
 }
 
-static enum ggml_status ggml_backend_gemmini_graph_compute(ggml_backend_t backend, struct ggml_cgraph * cgraph) {
-    ggml_backend_gemmini_context * ctx = (ggml_backend_gemmini_context *)backend->context;
+// async 명령 : tensor 는 host buffer 에 있으므로 queue 순서대로 memcpy
+static void ggml_backend_gemmini_set_tensor_async(ggml_backend_t backend, struct ggml_tensor *tensor, const void *data, size_t offset, size_t size)
+{
+    ggml_backend_gemmini_context *ctx = (ggml_backend_gemmini_context *)backend->context;
+    GGML_ASSERT(ggml_backend_buffer_is_host(tensor->buffer));
+
+    ctx->queue->submit([tensor, data, offset, size] {
+        std::memcpy((char *)tensor->data + offset, data, size);
+    });
+}
+
+static void ggml_backend_gemmini_get_tensor_async(ggml_backend_t backend, const struct ggml_tensor *tensor, void *data, size_t offset, size_t size)
+{
+    ggml_backend_gemmini_context *ctx = (ggml_backend_gemmini_context *)backend->context;
+    GGML_ASSERT(ggml_backend_buffer_is_host(tensor->buffer));
+
+    ctx->queue->submit([tensor, data, offset, size] {
+        std::memcpy(data, (const char *)tensor->data + offset, size);
+    });
+}
+
+static ggml_guid_t ggml_backend_gemmini_guid(void);
+
+// 양쪽 모두 Gemmini backend 의 host buffer 일 때만 (그 외는 ggml 이 동기 복사로 처리)
+static bool ggml_backend_gemmini_cpy_tensor_async(ggml_backend_t backend_src, ggml_backend_t backend_dst, const struct ggml_tensor *src, struct ggml_tensor *dst)
+{
+    if (!ggml_guid_matches(backend_src->guid, ggml_backend_gemmini_guid()) ||
+        !ggml_backend_buffer_is_host(src->buffer) || !ggml_backend_buffer_is_host(dst->buffer))
+        return false;
+
+    // 다른 backend 의 queue 에서 만들어지는 src 는 먼저 완료시킴
+    if (backend_src != backend_dst)
+        ggml_backend_synchronize(backend_src);
+
+    ggml_backend_gemmini_context *ctx = (ggml_backend_gemmini_context *)backend_dst->context;
+    ctx->queue->submit([src, dst] {
+        std::memcpy(dst->data, src->data, ggml_nbytes(dst));
+    });
+    return true;
+}
+
+static void ggml_backend_gemmini_synchronize(ggml_backend_t backend)
+{
+    ggml_backend_gemmini_context *ctx = (ggml_backend_gemmini_context *)backend->context;
+    ctx->queue->synchronize();
+}
+
+// graph 실행 본체 : ctx->queue 의 worker thread (device 의 hart 에 고정) 에서 호출
+static enum ggml_status ggml_backend_gemmini_graph_run(ggml_backend_gemmini_context *ctx, struct ggml_cgraph *cgraph) {
+    // weight cache 가 budget 을 넘었으면 이전 graph 에서만 쓴 항목부터 해제 (이번 graph 의 참조가 생기기 전)
+    ctx->weight_cache->begin_graph();
 
-    // (1) bias_map 갱신
+    // (1) bias_map 갱신 : ADD(MUL_MAT, x) -> MUL_MAT 의 D preload 로 fusion
     ctx->bias_map.clear();
+    ctx->fused_out.clear();
+    ctx->fused_nodes.clear();
+    ctx->conv_map.clear();
+    ctx->ffn_map.clear();
+    ctx->rope_map.clear();
+    ctx->lm_head_map.clear();
+    ctx->mm_groups.clear();
+
+    std::map<const ggml_tensor *, int> n_uses;
+    std::map<const ggml_tensor *, int> node_idx;
+    for (int i = 0; i < cgraph->n_nodes; i++) {
+        auto *node = cgraph->nodes[i];
+        node_idx[node] = i;
+        for (int s = 0; s < GGML_MAX_SRC && node->src[s]; s++)
+            n_uses[node->src[s]]++;
+    }
+
+    // IM2COL -> MUL_MAT (ggml_conv_1d / ggml_conv_2d) : native conv 로 대체
+    for (int i = 0; i < cgraph->n_nodes; i++) {
+        auto *node = cgraph->nodes[i];
+        if (node->op != GGML_OP_MUL_MAT)
+            continue;
+
+        if (ggml_tensor *im2col = ggml_backend_gemmini_can_fuse_conv(node, n_uses)) {
+            ctx->conv_map[node] = im2col;
+            ctx->fused_nodes.insert(im2col);
+        }
+    }
+
+    // MUL(SILU(gate), up) / GLU(SWIGLU) : gate | up matmul 하나 + epilogue
+    for (int i = 0; i < cgraph->n_nodes; i++) {
+        auto *node = cgraph->nodes[i];
+        if (node->op != GGML_OP_MUL && node->op != GGML_OP_GLU)
+            continue;
+
+        ggml_gemmini_ffn_match m;
+        if (!ggml_backend_gemmini_match_ffn(node, n_uses, m) ||
+            ctx->conv_map.count(m.gate) || ctx->conv_map.count(m.up))
+            continue;
+
+        ctx->ffn_map[node] = m;
+        ctx->fused_nodes.insert(m.gate);
+        ctx->fused_nodes.insert(m.up);
+        if (m.silu)
+            ctx->fused_nodes.insert(m.silu);
+    }
+
     for (int i = 0; i < cgraph->n_nodes; i++) {
         auto *node = cgraph->nodes[i];
-        if (node->op == GGML_OP_ADD && node->src[0]->op == GGML_OP_MUL_MAT)
-            ctx->bias_map[node->src[0]] = node->src[1];
+        if (node->op != GGML_OP_ADD)
+            continue;
+
+        for (int s = 0; s < 2; s++) {
+            ggml_tensor *mm = node->src[s];
+            ggml_tensor *x  = node->src[1 - s];
+            if (ctx->conv_map.count(mm) || ctx->fused_nodes.count(mm))
+                continue;
+            if (ggml_backend_gemmini_can_fuse_add(mm, x, node, n_uses, node_idx)) {
+                ctx->bias_map[mm]  = x;
+                ctx->fused_out[mm] = node;
+                ctx->fused_nodes.insert(node);
+                break;
+            }
+        }
     }
 
+    // ROPE(RESHAPE(MUL_MAT)) : RoPE 를 MUL_MAT writeback epilogue 로
+    for (int i = 0; i < cgraph->n_nodes; i++) {
+        auto *node = cgraph->nodes[i];
+        if (node->op != GGML_OP_ROPE)
+            continue;
 
+        if (ggml_tensor *mm = ggml_backend_gemmini_match_rope(ctx, node, n_uses, node_idx)) {
+            ctx->rope_map[mm] = node;
+            ctx->fused_nodes.insert(node);
+        }
+    }
+
+    // ARGMAX / top-k (LM head) : vocab chunk 단위 matmul + running top-k epilogue
+    for (int i = 0; i < cgraph->n_nodes; i++) {
+        auto *node = cgraph->nodes[i];
+        if (node->op != GGML_OP_ARGMAX && node->op != GGML_OP_VIEW)
+            continue;
+
+        ggml_tensor *mm;
+        ggml_gemmini_lm_head h;
+        if (ggml_backend_gemmini_match_lm_head(cgraph, node, n_uses, node_idx, mm, h) &&
+            !ctx->fused_nodes.count(mm) && !ctx->conv_map.count(mm) && !ctx->bias_map.count(mm) &&
+            !ctx->lm_head_map.count(mm)) {
+            ctx->lm_head_map[mm] = h;
+            ctx->fused_nodes.insert(h.sel);
+        }
+    }
+
+    // Q / K / V 등 같은 activation 을 쓰는 MUL_MAT : staging 1 번 + 이어 붙인 weight 로 matmul 1 번
+    ggml_backend_gemmini_plan_mul_mat_groups(ctx, cgraph);
+
+    // 같은 activation 을 staging 하는 노드가 여럿이면 int8 버퍼를 마지막 consumer 까지 공유
+    // token 수가 작은 단독 MUL_MAT 은 다른 graph 와 batching 하도록 weight 를 실행 순서대로 등록
+    ctx->staging->clear();
+    ctx->batch_nodes.clear();
+    std::vector<const ggml_tensor *> batch_ws;
+    for (int i = 0; i < cgraph->n_nodes; i++) {
+        auto *node = cgraph->nodes[i];
+        if (node->op == GGML_OP_MUL_MAT && !ctx->fused_nodes.count(node) && !ctx->conv_map.count(node) &&
+            !ggml_backend_gemmini_use_kv_mul_mat(ctx, node)) {
+            ctx->staging->plan(node->src[1], GEMMINI_STAGE_ROWS, i);
+            const bool single = !ctx->mm_groups.count(node) && !ctx->lm_head_map.count(node);
+            if (single && !ggml_gemmini_weight_cache::cacheable(node->src[0]) &&
+                !ggml_backend_gemmini_gemv_preferred(ctx, node->src[0], node->ne[1]))
+                ctx->staging->plan(node->src[0], GEMMINI_STAGE_TRANSPOSED, i);
+            if (single && node->ne[1] <= GGML_GEMMINI_BATCH_MAX_I &&
+                ggml_gemmini_weight_cache::cacheable(node->src[0])) {
+                ctx->batch_nodes.insert(node);
+                batch_ws.push_back(node->src[0]);
+            }
+        }
+        auto ft = ctx->ffn_map.find(node);
+        if (ft != ctx->ffn_map.end())
+            ctx->staging->plan(ft->second.gate->src[1], GEMMINI_STAGE_ROWS, i);
+    }
+    ctx->batch_graph = ctx->batcher->enter(batch_ws);
+
+    // (2) 임시 텐서용 context : 최초 1 회 생성 후 graph 마다 재사용
+    if (!ctx->tmp_ctx_initialized) {
         struct ggml_init_params ip = {
             /* .mem_size   = */ 320ull * 1024 * 1024, // 320MiB
             /* .mem_buffer = */ NULL,
@@ -123,7 +434,10 @@ static enum ggml_status ggml_backend_gemmini_graph_compute(ggml_backend_t backen
 
         ctx->tmp_ctx = ggml_init(ip);
         GGML_ASSERT(ctx->tmp_ctx);
-
+        ctx->tmp_ctx_initialized = true;
+    } else {
+        ggml_reset(ctx->tmp_ctx);
+    }
 
     for (int i = 0; i < cgraph->n_nodes; i++)
     {
@@ -132,14 +446,121 @@ static enum ggml_status ggml_backend_gemmini_graph_compute(ggml_backend_t backen
         switch (node->op)
         {
         case GGML_OP_MUL_MAT: {
+            if (ctx->fused_nodes.count(node))
+                break;
+
+            auto ht = ctx->lm_head_map.find(node);
+            if (ht != ctx->lm_head_map.end()) {
+                ggml_backend_gemmini_lm_head(ctx, node, ht->second);
+                break;
+            }
+
+            auto gt = ctx->mm_groups.find(node);
+            if (gt != ctx->mm_groups.end()) {
+                ggml_backend_gemmini_mul_mat_group(ctx, gt->second);
+                break;
+            }
+
+            auto ct = ctx->conv_map.find(node);
+            if (ct != ctx->conv_map.end()) {
+                ggml_backend_gemmini_conv_mul_mat(ctx, node, ct->second);
+                break;
+            }
+
             ggml_tensor *bias = nullptr;
             auto it = ctx->bias_map.find(node);
             if (it != ctx->bias_map.end())
                 bias = it->second;
 
-            ggml_backend_gemmini_mul_mat(ctx, node, bias);
+            ggml_tensor *out = node;
+            auto jt = ctx->fused_out.find(node);
+            if (jt != ctx->fused_out.end())
+                out = jt->second;
+
+            const ggml_tensor *rope = nullptr;
+            auto rt = ctx->rope_map.find(node);
+            if (rt != ctx->rope_map.end())
+                rope = rt->second;
+
+            if (ggml_backend_gemmini_use_kv_mul_mat(ctx, node)) {
+                ggml_backend_gemmini_kv_mul_mat(ctx, node);
+                break;
+            }
 
+            ggml_backend_gemmini_mul_mat(ctx, node, bias, out, rope);
+            break;
         }
+        case GGML_OP_MUL_MAT_ID:
+            ggml_backend_gemmini_mul_mat_id(ctx, node);
+            break;
+
+        case GGML_OP_ADD:
+            if (ctx->fused_nodes.count(node) == 0)
+                ggml_backend_gemmini_add(ctx, node);
+            break;
+
+        case GGML_OP_MUL:
+        case GGML_OP_GLU: {
+            auto ft = ctx->ffn_map.find(node);
+            if (ft != ctx->ffn_map.end())
+                ggml_backend_gemmini_ffn(ctx, node, ft->second);
+            else
+                ggml_backend_gemmini_elementwise(ctx, node);
+            break;
+        }
+        case GGML_OP_UNARY:
+            if (ctx->fused_nodes.count(node) == 0)
+                ggml_backend_gemmini_elementwise(ctx, node);
+            break;
+
+        case GGML_OP_ARGMAX:
+        case GGML_OP_ARGSORT:
+            if (ctx->fused_nodes.count(node) == 0)
+                ggml_backend_gemmini_select(ctx, node);
+            break;
+
+        case GGML_OP_ROPE:
+            // epilogue 에서 이미 회전된 값이 입력 버퍼에 있음 : in-place 할당이 아니면 복사만
+            if (ctx->fused_nodes.count(node) == 0)
+                ggml_backend_gemmini_rope(ctx, node);
+            else if (node->data != node->src[0]->data)
+                std::memcpy(node->data, node->src[0]->data, ggml_nbytes(node));
+            break;
+
+        case GGML_OP_SET_ROWS:
+        case GGML_OP_CPY:
+            ggml_backend_gemmini_kv_write(ctx, node);
+            break;
+
+        case GGML_OP_CONV_2D:
+            ggml_backend_gemmini_conv_2d(ctx, node);
+            break;
+
+        case GGML_OP_CONV_2D_DW:
+            ggml_backend_gemmini_conv_2d_dw(ctx, node);
+            break;
+
+        case GGML_OP_CONV_TRANSPOSE_1D:
+            ggml_backend_gemmini_conv_transpose_1d(ctx, node);
+            break;
+
+        case GGML_OP_CONV_TRANSPOSE_2D:
+            ggml_backend_gemmini_conv_transpose_2d(ctx, node);
+            break;
+
+        case GGML_OP_POOL_2D:
+            ggml_backend_gemmini_pool_2d(ctx, node);
+            break;
+
+        case GGML_OP_MEAN:
+            ggml_backend_gemmini_mean(ctx, node);
+            break;
+
+        case GGML_OP_IM2COL:
+            if (ctx->fused_nodes.count(node) == 0)
+                ggml_backend_gemmini_im2col(ctx, node);
+            break;
+
         case GGML_OP_OUT_PROD:
             // ggml_backend_gemmini_out_prod(ctx, node);
             break;
@@ -154,21 +575,48 @@ static enum ggml_status ggml_backend_gemmini_graph_compute(ggml_backend_t backen
         default:
             GGML_ABORT("%s: unsupported op %s\n", __func__, ggml_op_desc(node));
         }
+        ctx->staging->release(i);
+        ctx->kv_cache->on_write(node);
     }
     ctx->bias_map.clear();
+    ctx->fused_out.clear();
+    ctx->fused_nodes.clear();
+    ctx->conv_map.clear();
+    ctx->ffn_map.clear();
+    ctx->rope_map.clear();
+    ctx->lm_head_map.clear();
+    ctx->mm_groups.clear();
+    ctx->staging->clear();
+    ctx->batcher->leave(ctx->batch_graph);
+    ctx->batch_nodes.clear();
+    ctx->batch_graph = -1;
 
     return GGML_STATUS_SUCCESS;
+}
 
-    GGML_UNUSED(backend);
+// queue 에서 실행하고 끝날 때까지 대기
+//   buffer 가 CPU backend 와 같은 host buffer 라 ggml_backend_sched 는 split 사이에 복사 / synchronize 를
+//   넣지 않음 : 바로 반환하면 다음 CPU split 이 아직 쓰이지 않은 결과를 읽게 되므로 동기로 둔다
+//   (set / get / cpy 는 sched 가 synchronize 를 부르므로 async 유지)
+static enum ggml_status ggml_backend_gemmini_graph_compute(ggml_backend_t backend, struct ggml_cgraph *cgraph) {
+    ggml_backend_gemmini_context *ctx = (ggml_backend_gemmini_context *)backend->context;
+
+    enum ggml_status status = GGML_STATUS_SUCCESS;
+    ctx->queue->submit([ctx, cgraph, &status] {
+        // device 사용권은 Gemmini 호출마다 잡음 : graph 동안 잡으면 다른 graph 가 batcher 에 합류하지 못함
+        status = ggml_backend_gemmini_graph_run(ctx, cgraph);
+    });
+    ctx->queue->synchronize();
+    return status;
 }
 
 static struct ggml_backend_i gemmini_backend_i = {
     /* .get_name                = */ ggml_backend_gemmini_get_name,
     /* .free                    = */ ggml_backend_gemmini_free,
-    /* .set_tensor_async        = */ NULL,
-    /* .get_tensor_async        = */ NULL,
-    /* .cpy_tensor_async        = */ NULL,
-    /* .synchronize             = */ NULL,
+    /* .set_tensor_async        = */ ggml_backend_gemmini_set_tensor_async,
+    /* .get_tensor_async        = */ ggml_backend_gemmini_get_tensor_async,
+    /* .cpy_tensor_async        = */ ggml_backend_gemmini_cpy_tensor_async,
+    /* .synchronize             = */ ggml_backend_gemmini_synchronize,
     /* .graph_plan_create       = */ NULL,
     /* .graph_plan_free         = */ NULL,
     /* .graph_plan_update       = */ NULL,
@@ -184,20 +632,53 @@ static ggml_guid_t ggml_backend_gemmini_guid(void)
     return &guid;
 }
 
-ggml_backend_t ggml_backend_gemmini_init(void)
+static void ggml_backend_gemmini_set_n_threads(ggml_backend_t backend, int n_threads)
+{
+    GGML_ASSERT(backend != NULL && ggml_guid_matches(backend->guid, ggml_backend_gemmini_guid()));
+
+    ggml_backend_gemmini_context *ctx = (ggml_backend_gemmini_context *)backend->context;
+    ctx->queue->synchronize(); // 실행 중인 graph 와 겹치지 않도록
+    ctx->n_threads = n_threads;
+}
+
+// 큰 MUL_MAT 을 J (또는 I) 로 나눠 모든 device 에서 실행 (다른 device 가 Gemmini 호출 중이면 이 device 만)
+static void ggml_backend_gemmini_set_tensor_parallel(ggml_backend_t backend, bool enable)
 {
+    GGML_ASSERT(backend != NULL && ggml_guid_matches(backend->guid, ggml_backend_gemmini_guid()));
+
+    ggml_backend_gemmini_context *ctx = (ggml_backend_gemmini_context *)backend->context;
+    ctx->queue->synchronize(); // 실행 중인 graph 와 겹치지 않도록
+    ctx->tensor_parallel = enable;
+}
+
+static ggml_backend_t ggml_backend_gemmini_init_device(int index)
+{
+    const ggml_gemmini_device_info &info = ggml_gemmini_devices().at(index);
+
     ggml_backend_gemmini_context *ctx = new ggml_backend_gemmini_context;
+    ctx->device = info.index;
+    ctx->hart = info.hart;
+    ctx->weight_cache = std::make_shared<ggml_gemmini_weight_cache>();
+    ctx->staging = std::make_shared<ggml_gemmini_staging_cache>();
+    ctx->kv_cache = std::make_shared<ggml_gemmini_kv_cache>();
+    ctx->batcher = ggml_gemmini_batcher::shared();
+    ctx->queue = std::make_shared<ggml_gemmini_queue>(info.hart);
 
     ggml_backend_t backend = new ggml_backend{
         /* .guid      = */ ggml_backend_gemmini_guid(),
         /* .interface = */ gemmini_backend_i,
-        /* .device    = */ ggml_backend_reg_dev_get(ggml_backend_gemmini_reg(), 0),
+        /* .device    = */ ggml_backend_reg_dev_get(ggml_backend_gemmini_reg(), index),
         /* .context   = */ ctx,
     };
 
     return backend;
 }
 
+ggml_backend_t ggml_backend_gemmini_init(void)
+{
+    return ggml_backend_gemmini_init_device(0);
+}
+
 // bool ggml_backend_is_gemmini(ggml_backend_t backend) {
 //     return backend != NULL && ggml_guid_matches(backend->guid, ggml_backend_gemmini_guid());
 // }
@@ -206,16 +687,12 @@ ggml_backend_t ggml_backend_gemmini_init(void)
 
 static const char *ggml_backend_gemmini_device_get_name(ggml_backend_dev_t dev)
 {
-    return "GEMMINI";
-
-    GGML_UNUSED(dev);
+    return ((const ggml_gemmini_device_info *)dev->context)->name.c_str();
 }
 
 static const char *ggml_backend_gemmini_device_get_description(ggml_backend_dev_t dev)
 {
-    return "GEMMINI";
-
-    GGML_UNUSED(dev);
+    return ((const ggml_gemmini_device_info *)dev->context)->description.c_str();
 }
 
 static void ggml_backend_gemmini_device_get_memory(ggml_backend_dev_t dev, size_t *free, size_t *total)
@@ -241,7 +718,7 @@ static void ggml_backend_gemmini_device_get_props(ggml_backend_dev_t dev, struct
     props->type = ggml_backend_gemmini_device_get_type(dev);
     ggml_backend_gemmini_device_get_memory(dev, &props->memory_free, &props->memory_total);
     props->caps = {
-        /* .async                 = */ false,
+        /* .async                 = */ true,
         /* .host_buffer           = */ false,
         /* .buffer_from_host_ptr  = */ true,
         /* .events                = */ false,
@@ -250,9 +727,8 @@ static void ggml_backend_gemmini_device_get_props(ggml_backend_dev_t dev, struct
 
 static ggml_backend_t ggml_backend_gemmini_device_init_backend(ggml_backend_dev_t dev, const char *params)
 {
-    return ggml_backend_gemmini_init();
+    return ggml_backend_gemmini_init_device(((const ggml_gemmini_device_info *)dev->context)->index);
 
-    GGML_UNUSED(dev);
     GGML_UNUSED(params);
 }
 
@@ -299,14 +775,67 @@ static bool ggml_backend_gemmini_device_supports_op(ggml_backend_dev_t dev, cons
         // TODO: find the optimal value
         const int64_t min_batch = 32;
 
-        return ggml_is_contiguous(src0) &&
-               ggml_is_contiguous(src1) &&
-               // src1->type == GGML_TYPE_F32 &&
-               // (ne0 >= min_batch && ne1 >= min_batch && ne10 >= min_batch) &&
-               // (src0->type == GGML_TYPE_F32 || ggml_get_type_traits(src0->type)->to_float != NULL);
-               true;
+        return (ggml_is_contiguous(src0) &&
+                ggml_is_contiguous(src1) &&
+                // src1->type == GGML_TYPE_F32 &&
+                // (ne0 >= min_batch && ne1 >= min_batch && ne10 >= min_batch) &&
+                // (src0->type == GGML_TYPE_F32 || ggml_get_type_traits(src0->type)->to_float != NULL);
+                true) ||
+               ggml_backend_gemmini_kv_mul_mat_supported(op);
     }
 
+    case GGML_OP_SET_ROWS:
+    case GGML_OP_CPY:
+        return ggml_backend_gemmini_kv_write_supported(op);
+
+    case GGML_OP_MUL_MAT_ID:
+        return ggml_backend_gemmini_mul_mat_id_supported(op);
+
+    case GGML_OP_ADD:
+        // residual / bias : src1 은 src0 shape 으로 broadcast
+        return op->type == GGML_TYPE_F32 &&
+               src0->type == GGML_TYPE_F32 &&
+               src1->type == GGML_TYPE_F32 &&
+               ggml_are_same_shape(src0, op) &&
+               ggml_can_repeat(src1, src0);
+
+    case GGML_OP_MUL:
+    case GGML_OP_UNARY:
+    case GGML_OP_GLU:
+        // gated FFN 패턴은 graph_compute 에서 gate / up MUL_MAT 과 함께 fusion
+        return ggml_backend_gemmini_elementwise_supported(op);
+
+    case GGML_OP_ARGMAX:
+    case GGML_OP_ARGSORT:
+        // LM head 의 argmax / top-k 는 graph_compute 에서 MUL_MAT epilogue 로 fusion
+        return ggml_backend_gemmini_select_supported(op);
+
+    case GGML_OP_ROPE:
+        // ROPE(RESHAPE(MUL_MAT)) 은 graph_compute 에서 MUL_MAT epilogue 로 fusion
+        return ggml_backend_gemmini_rope_supported(op);
+
+    case GGML_OP_CONV_2D:
+        return ggml_backend_gemmini_conv_2d_supported(op);
+
+    case GGML_OP_CONV_2D_DW:
+        return ggml_backend_gemmini_conv_2d_dw_supported(op);
+
+    case GGML_OP_CONV_TRANSPOSE_1D:
+    case GGML_OP_CONV_TRANSPOSE_2D:
+        return ggml_backend_gemmini_conv_transpose_supported(op);
+
+    case GGML_OP_POOL_2D:
+        return ggml_backend_gemmini_pool_2d_supported(op);
+
+    case GGML_OP_MEAN:
+        return ggml_backend_gemmini_mean_supported(op);
+
+    case GGML_OP_IM2COL:
+        // host fallback : IM2COL -> MUL_MAT 패턴이면 graph_compute 에서 native conv 로 대체
+        return src1->type == GGML_TYPE_F32 &&
+               (op->type == GGML_TYPE_F32 || op->type == GGML_TYPE_F16) &&
+               ggml_is_contiguous(op);
+
     case GGML_OP_OUT_PROD:
         // return op->src[0]->type == GGML_TYPE_F32 &&
         //        op->src[1]->type == GGML_TYPE_F32 &&
@@ -359,32 +888,72 @@ static const char *ggml_backend_gemmini_reg_get_name(ggml_backend_reg_t reg)
 
 static size_t ggml_backend_gemmini_reg_get_device_count(ggml_backend_reg_t reg)
 {
-    return 1;
+    return ggml_gemmini_devices().size();
 
     GGML_UNUSED(reg);
 }
 
 static ggml_backend_dev_t ggml_backend_gemmini_reg_get_device(ggml_backend_reg_t reg, size_t index)
 {
-    GGML_ASSERT(index == 0);
+    static std::vector<ggml_backend_device> ggml_backend_gemmini_devices = [reg] {
+        std::vector<ggml_backend_device> v;
+        for (const ggml_gemmini_device_info &info : ggml_gemmini_devices())
+            v.push_back({
+                /* .iface   = */ ggml_backend_gemmini_device_i,
+                /* .reg     = */ reg,
+                /* .context = */ (void *)&info,
+            });
+        return v;
+    }();
+
+    GGML_ASSERT(index < ggml_backend_gemmini_devices.size());
+    return &ggml_backend_gemmini_devices[index];
+}
 
-    static ggml_backend_device ggml_backend_gemmini_device = {
-        /* .iface   = */ ggml_backend_gemmini_device_i,
-        /* .reg     = */ reg,
-        /* .context = */ nullptr,
-    };
+// KV cache 텐서를 incremental staging 대상으로 등록
+//   이후 그 텐서에 대한 쓰기는 이 backend 의 graph 에서 실행되거나 invalidate 로 알려야 함
+static void ggml_backend_gemmini_kv_register(ggml_backend_t backend, const ggml_tensor *tensor)
+{
+    GGML_ASSERT(backend != NULL && ggml_guid_matches(backend->guid, ggml_backend_gemmini_guid()));
+
+    ggml_backend_gemmini_context *ctx = (ggml_backend_gemmini_context *)backend->context;
+    ctx->queue->synchronize(); // 실행 중인 graph 와 겹치지 않도록
+    ctx->kv_cache->reg(view_root(tensor));
+}
+
+// backend 밖 (ggml_backend_tensor_set, 다른 backend) 에서 KV 텐서를 썼을 때 staging 무효화
+static void ggml_backend_gemmini_kv_invalidate(ggml_backend_t backend, const ggml_tensor *tensor)
+{
+    GGML_ASSERT(backend != NULL && ggml_guid_matches(backend->guid, ggml_backend_gemmini_guid()));
+
+    ggml_backend_gemmini_context *ctx = (ggml_backend_gemmini_context *)backend->context;
+    ctx->queue->synchronize(); // 실행 중인 graph 와 겹치지 않도록
+    const ggml_tensor *root = view_root(tensor);
+    const size_t b0 = (const char *)tensor->data - (const char *)root->data;
+    ctx->kv_cache->invalidate(root, b0, b0 + ggml_nbytes(tensor));
+}
+
+static void *ggml_backend_gemmini_get_proc_address(ggml_backend_reg_t reg, const char *name)
+{
+    if (std::strcmp(name, "ggml_backend_set_n_threads") == 0)
+        return (void *)ggml_backend_gemmini_set_n_threads;
+    if (std::strcmp(name, "ggml_backend_gemmini_set_tensor_parallel") == 0)
+        return (void *)ggml_backend_gemmini_set_tensor_parallel;
+    if (std::strcmp(name, "ggml_backend_gemmini_kv_register") == 0)
+        return (void *)ggml_backend_gemmini_kv_register;
+    if (std::strcmp(name, "ggml_backend_gemmini_kv_invalidate") == 0)
+        return (void *)ggml_backend_gemmini_kv_invalidate;
 
-    return &ggml_backend_gemmini_device;
+    return NULL;
 
     GGML_UNUSED(reg);
-    GGML_UNUSED(index);
 }
 
 static const struct ggml_backend_reg_i ggml_backend_gemmini_reg_i = {
     /* .get_name         = */ ggml_backend_gemmini_reg_get_name,
     /* .get_device_count = */ ggml_backend_gemmini_reg_get_device_count,
     /* .get_device       = */ ggml_backend_gemmini_reg_get_device,
-    /* .get_proc_address = */ NULL,
+    /* .get_proc_address = */ ggml_backend_gemmini_get_proc_address,
 };
 
 ggml_backend_reg_t ggml_backend_gemmini_reg(void)